@@ -0,0 +1,111 @@
+#include "Buffered_writer.h"
+#include "Utility.h"
+using std::string;
+using std::vector;
+using std::mutex;
+using std::lock_guard;
+using std::unique_lock;
+
+const std::size_t Buffered_writer::DEFAULT_BUFFER_SIZE = 1 << 20;
+const std::size_t Buffered_writer::MAX_QUEUED_BUFFERS = 16;
+
+// open the file and start the background thread
+Buffered_writer::Buffered_writer(const string& filename, std::size_t buffer_size_)
+  :file(filename.c_str(), std::ios::binary | std::ios::trunc), buffer_size(buffer_size_),
+  stopping(false), dropped_buffers(0), failed(false)
+{
+  if (!file)
+    throw Error("Cannot open output file!");
+  current.reserve(buffer_size);
+  worker = std::thread(&Buffered_writer::write_buffers, this);
+}
+
+// close, if not yet closed
+Buffered_writer::~Buffered_writer()
+{
+  close();
+}
+
+// write everything appended, stop the background thread, and close the file;
+// the last buffer is queued however many are waiting
+void Buffered_writer::close()
+{
+  if (!worker.joinable()) return;
+  {
+    lock_guard<mutex> lock(queue_mutex);
+    if (!current.empty()) full.push_back(std::move(current));
+    stopping = true;
+  }
+  queue_ready.notify_one();
+  worker.join();
+  file.close();
+  if (!file) failed = true;
+}
+
+// append n bytes; hands the buffer to the background thread when it fills
+void Buffered_writer::append(const char* data, std::size_t n)
+{
+  current.insert(current.end(), data, data + n);
+  if (current.size() >= buffer_size)
+    flush();
+}
+
+// move the current buffer onto the queue and continue in a spare one
+void Buffered_writer::flush()
+{
+  if (current.empty()) return;
+  vector<char> next;
+  {
+    lock_guard<mutex> lock(queue_mutex);
+    // the disk is too far behind; lose this buffer rather than hold up the caller
+    if (full.size() >= MAX_QUEUED_BUFFERS) {
+      ++dropped_buffers;
+      current.clear();
+      return;
+    }
+    full.push_back(std::move(current));
+    if (!spare.empty()) {
+      next.swap(spare.back());
+      spare.pop_back();
+    }
+  }
+  queue_ready.notify_one();
+  next.clear();
+  next.reserve(buffer_size);
+  current.swap(next);
+}
+
+// write full buffers in order until told to stop and none are left
+void Buffered_writer::write_buffers()
+{
+  unique_lock<mutex> lock(queue_mutex);
+  while (true) {
+    queue_ready.wait(lock, [this]{return stopping || !full.empty();});
+    if (full.empty()) break; // stopping, and everything is written
+    vector<char> buffer(std::move(full.front()));
+    full.pop_front();
+    lock.unlock();
+    // hand the bytes to the system, so that a crash after this loses none of them;
+    // after a failure the stream writes nothing more
+    file.write(buffer.data(), buffer.size());
+    file.flush();
+    bool write_failed = !file;
+    lock.lock();
+    if (write_failed) failed = true;
+    spare.push_back(std::move(buffer));
+  }
+}
+
+// the number of buffers dropped because too many were waiting
+long Buffered_writer::get_dropped_buffers() const
+{
+  lock_guard<mutex> lock(queue_mutex);
+  return dropped_buffers;
+}
+
+// true once writing to the file has failed
+bool Buffered_writer::has_failed() const
+{
+  lock_guard<mutex> lock(queue_mutex);
+  return failed;
+}
@@ -0,0 +1,74 @@
+/* Buffered_writer appends bytes to a file through large in-memory buffers.
+A buffer that fills up is handed to a background thread that writes it to the file,
+so append() never waits for the disk: handing over only moves the buffer onto a queue
+under a lock and picks up a spare one. Each buffer is flushed to the system once
+written, so what has been handed over survives the program crashing. Buffers are
+recycled once written.
+If the disk falls behind so that MAX_QUEUED_BUFFERS are waiting, a further buffer is
+dropped rather than queued, so that neither memory nor append() grows with the
+backlog; the drops are counted. A failed write is remembered, and the rest is
+discarded. The owner reports either.
+close(), or else the destructor, writes whatever is left, stops the thread, and
+closes the file.
+*/
+#ifndef BUFFERED_WRITER_H
+#define BUFFERED_WRITER_H
+#include <string>
+#include <vector>
+#include <deque>
+#include <fstream>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+class Buffered_writer {
+public:
+  // open the file for writing
+  // will throw Error("Cannot open output file!")
+  Buffered_writer(const std::string& filename, std::size_t buffer_size_ = DEFAULT_BUFFER_SIZE);
+  // close, if not yet closed
+  ~Buffered_writer();
+  // write everything appended, stop the background thread, and close the file;
+  // nothing may be appended after
+  void close();
+
+  // append n bytes; hands the buffer to the background thread when it fills
+  void append(const char* data, std::size_t n);
+  void append(const std::string& data)
+    {append(data.data(), data.size());}
+  // hand the current buffer to the background thread even if not full;
+  // it is dropped if MAX_QUEUED_BUFFERS are already waiting
+  void flush();
+
+  // the number of buffers dropped because too many were waiting
+  long get_dropped_buffers() const;
+  // true once writing to the file has failed
+  bool has_failed() const;
+
+  // disallow copy/move construction or assignment
+  Buffered_writer(const Buffered_writer&) = delete;
+  Buffered_writer(Buffered_writer&&) = delete;
+  Buffered_writer& operator= (const Buffered_writer&) = delete;
+  Buffered_writer& operator= (Buffered_writer&&) = delete;
+
+private:
+  static const std::size_t DEFAULT_BUFFER_SIZE;
+  static const std::size_t MAX_QUEUED_BUFFERS;
+
+  std::ofstream file;
+  std::size_t buffer_size;
+  std::vector<char> current; // the buffer being appended to
+  std::deque<std::vector<char>> full; // buffers waiting to be written, oldest first
+  std::vector<std::vector<char>> spare; // written buffers kept for reuse
+  mutable std::mutex queue_mutex; // guards full, spare, stopping, dropped_buffers and failed
+  std::condition_variable queue_ready;
+  bool stopping;
+  long dropped_buffers;
+  bool failed;
+  std::thread worker;
+
+  // body of the background thread: write full buffers until stopping
+  void write_buffers();
+};
+
+#endif
@@ -0,0 +1,65 @@
+#include "Command_journal.h"
+#include "Buffered_writer.h"
+#include "Utility.h"
+#include <fstream>
+#include <iterator>
+#include <cstring>
+#include <cstdint>
+using std::string;
+using std::vector;
+
+// identifies a journal file
+static const char MAGIC[] = "P5JRNL1\n";
+static const std::size_t MAGIC_SIZE = sizeof(MAGIC) - 1;
+
+// create the journal file
+Command_journal::Command_journal(const string& filename)
+  :writer(new Buffered_writer(filename)), last_tick(0)
+{
+  writer->append(MAGIC, MAGIC_SIZE);
+}
+
+// the writer completes the file
+Command_journal::~Command_journal()
+{}
+
+// append the command applied at the tick
+void Command_journal::append(int tick, const string& command)
+{
+  if (tick != last_tick) {
+    writer->flush();
+    last_tick = tick;
+  }
+  int32_t record_tick = tick;
+  uint32_t length = uint32_t(command.size());
+  writer->append(reinterpret_cast<const char*>(&record_tick), sizeof(record_tick));
+  writer->append(reinterpret_cast<const char*>(&length), sizeof(length));
+  writer->append(command);
+}
+
+// read the journal's commands into text, one per line, with the tick of each in ticks
+void read_journal(const string& filename, string& text, vector<int>& ticks)
+{
+  std::ifstream file(filename, std::ios::binary);
+  if (!file)
+    throw Error("Cannot read journal file!");
+  string contents((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+  if (contents.size() < MAGIC_SIZE || contents.compare(0, MAGIC_SIZE, MAGIC))
+    throw Error("Cannot read journal file!");
+  text.clear();
+  ticks.clear();
+  std::size_t pos = MAGIC_SIZE;
+  // a record cut short by a crash ends the journal
+  while (contents.size() - pos >= sizeof(int32_t) + sizeof(uint32_t)) {
+    int32_t tick;
+    uint32_t length;
+    std::memcpy(&tick, contents.data() + pos, sizeof(tick));
+    std::memcpy(&length, contents.data() + pos + sizeof(tick), sizeof(length));
+    pos += sizeof(tick) + sizeof(length);
+    if (contents.size() - pos < length) break;
+    text.append(contents, pos, length);
+    text += '\n';
+    ticks.push_back(tick);
+    pos += length;
+  }
+}
@@ -0,0 +1,49 @@
+/* Command_journal
+A Command_journal appends every command the Controller accepted to a binary file,
+so that a run can be reproduced by replaying it. The file starts with the magic
+"P5JRNL1\n"; then each command is a record of the tick it was applied at (int32),
+the length of its text (uint32), and the text. The text is the command as it was
+read - its words, and its numbers printed so that they read back exactly - on one line.
+
+The records are written through a Buffered_writer, which is flushed whenever the
+tick changes, so at most the commands of the current tick are lost if the program
+does not end normally.
+
+read_journal reads a journal file back as the commands' text, one per line, and
+the tick of each.
+*/
+#ifndef COMMAND_JOURNAL_H
+#define COMMAND_JOURNAL_H
+#include <string>
+#include <vector>
+#include <memory>
+
+class Buffered_writer;
+
+class Command_journal {
+public:
+  // create the journal file
+  // will throw Error("Cannot open output file!")
+  Command_journal(const std::string& filename);
+  // the writer completes the file
+  ~Command_journal();
+
+  // append the command applied at the tick
+  void append(int tick, const std::string& command);
+
+  // disallow copy/move construction or assignment
+  Command_journal(const Command_journal&) = delete;
+  Command_journal(Command_journal&&) = delete;
+  Command_journal& operator= (const Command_journal&) = delete;
+  Command_journal& operator= (Command_journal&&) = delete;
+
+private:
+  std::unique_ptr<Buffered_writer> writer;
+  int last_tick;    // the tick of the last record
+};
+
+// read the journal's commands into text, one per line, with the tick of each in ticks
+// will throw Error("Cannot read journal file!")
+void read_journal(const std::string& filename, std::string& text, std::vector<int>& ticks);
+
+#endif
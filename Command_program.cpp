@@ -0,0 +1,164 @@
+#include "Command_program.h"
+#include "Model.h"
+#include "Ship.h"
+#include <algorithm>
+using std::string;
+using std::vector;
+using std::shared_ptr;
+
+// compile each non-blank line to an instruction
+Command_program::Command_program(const char* begin, const char* end,
+  const Command_signatures& commands, const Command_signatures& ship_commands)
+{
+  vector<string> tokens;
+  const char* p = begin;
+  while (p < end) {
+    // split the line into its words
+    tokens.clear();
+    const char* text = nullptr;
+    while (p < end && *p != '\n') {
+      if (is_command_space(*p)) {
+        ++p;
+        continue;
+      }
+      const char* start = p;
+      while (p < end && !is_command_space(*p)) ++p;
+      if (!text) text = start;
+      tokens.emplace_back(start, p);
+    }
+    if (p < end) ++p; // the newline
+    if (tokens.empty()) continue;
+
+    Instruction instruction = {Kind::INTERPRET, 0, intern(tokens[0]), int(operands.size()), 0, text};
+    if (tokens[0] == "quit") {
+      instruction.kind = Kind::QUIT;
+    } else {
+      auto command = commands.find(tokens[0]);
+      if (command != commands.end() && compile_operands(tokens, 1, command->second.operands)) {
+        instruction.kind = Kind::GENERAL;
+        instruction.opcode = command->second.opcode;
+      } else if (tokens.size() > 1) {
+        auto ship_command = ship_commands.find(tokens[1]);
+        if (ship_command != ship_commands.end() && compile_operands(tokens, 2, ship_command->second.operands)) {
+          instruction.kind = Kind::SHIP;
+          instruction.opcode = ship_command->second.opcode;
+        }
+      }
+    }
+    instruction.end_operand = int(operands.size());
+    instructions.push_back(instruction);
+  }
+}
+
+// the index of the instruction whose line starts with the word at text, or NO_INSTRUCTION
+int Command_program::find_instruction(const char* text) const
+{
+  auto it = std::lower_bound(instructions.begin(), instructions.end(), text,
+    [](const Instruction& instruction, const char* t) {return instruction.text < t;});
+  if (it == instructions.end() || it->text != text) return NO_INSTRUCTION;
+  return int(it - instructions.begin());
+}
+
+// the ship currently named by the symbol, or nullptr if there is none
+shared_ptr<Ship> Command_program::get_ship(int symbol)
+{
+  Symbol& entry = symbols[symbol];
+  unsigned version = Model::get_Instance().get_ships_version();
+  if (entry.version != version) {
+    shared_ptr<Ship> ship = Model::get_Instance().find_ship(entry.name);
+    entry.ship = ship ? ship->get_handle() : Ship_handle();
+    entry.version = version;
+  }
+  Ship* ship = Model::get_Instance().get_ship(entry.ship);
+  return ship ? ship->shared_from_this() : nullptr;
+}
+
+// the symbol for the name, interning it if new
+int Command_program::intern(const string& name)
+{
+  auto it = symbol_indices.find(name);
+  if (it != symbol_indices.end()) return it->second;
+  int symbol = int(symbols.size());
+  // a version the Model has not reached yet, so the first get_ship looks up
+  Symbol entry = {name, Model::get_Instance().get_ships_version() - 1, Ship_handle()};
+  symbols.push_back(entry);
+  symbol_indices[name] = symbol;
+  return symbol;
+}
+
+// append the tokens as operands of the given kinds; return false, leaving
+// no operands behind, if they do not match
+bool Command_program::compile_operands(const vector<string>& tokens, std::size_t first, const string& kinds)
+{
+  if (tokens.size() - first != kinds.size()) return false;
+  std::size_t operands_size = operands.size(), words_size = words.size(), islands_size = islands.size();
+  for (std::size_t i = 0; i < kinds.size(); ++i) {
+    const string& token = tokens[first + i];
+    const char* p = token.data();
+    const char* token_end = p + token.size();
+    Operand operand = {kinds[i], 0., 0};
+    bool valid = true;
+    switch (kinds[i]) {
+      case 'w':
+        operand.integer = int(words.size());
+        words.push_back(token);
+        break;
+      case 'd':
+        valid = parse_double(p, token_end, operand.number) && p == token_end;
+        break;
+      case 'n':
+        valid = parse_int(p, token_end, operand.integer) && p == token_end;
+        break;
+      case 'i': {
+        shared_ptr<Island> island = Model::get_Instance().find_island(token);
+        valid = island != nullptr;
+        operand.integer = int(islands.size());
+        islands.push_back(island);
+        break;
+      }
+      default:
+        valid = false;
+        break;
+    }
+    if (!valid) {
+      operands.resize(operands_size);
+      words.resize(words_size);
+      islands.resize(islands_size);
+      return false;
+    }
+    operands.push_back(operand);
+  }
+  return true;
+}
+
+Program_reader::Program_reader(const Command_program& program_, const Command_program::Instruction& instruction)
+  :program(program_), next(instruction.first_operand), end(instruction.end_operand)
+{}
+
+bool Program_reader::read_word(string& word)
+{
+  if (next == end || program.operands[next].kind != 'w') return false;
+  word = program.words[program.operands[next++].integer];
+  return true;
+}
+
+bool Program_reader::read_double(double& value)
+{
+  if (next == end || program.operands[next].kind != 'd') return false;
+  value = program.operands[next++].number;
+  return true;
+}
+
+bool Program_reader::read_int(int& value)
+{
+  if (next == end || program.operands[next].kind != 'n') return false;
+  value = program.operands[next++].integer;
+  return true;
+}
+
+bool Program_reader::read_island(shared_ptr<Island>& island)
+{
+  if (next == end || program.operands[next].kind != 'i') return false;
+  island = program.islands[program.operands[next++].integer];
+  return true;
+}
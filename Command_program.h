@@ -0,0 +1,113 @@
+/* Command_program
+A Command_program is a command script compiled once, so that replaying it does
+not tokenize, parse numbers, or look up command and island names again.
+
+Each non-blank line of the script becomes one Instruction. A line that holds exactly
+one command whose operands are all valid is compiled: the opcode picks the handler
+from the Controller's jump table, numbers are parsed, and island names are resolved
+to the islands themselves. Ship names are interned as symbols that hold the handle of
+their ship, looked up by name again only when the Model's set of ships has changed,
+so a program does not keep a ship that has gone alive.
+
+Any other line is left to be interpreted from its text, and so is a compiled line
+whose first word turns out to mean something else when it runs, such as a command
+keyword that has become the name of a ship.
+*/
+#ifndef COMMAND_PROGRAM_H
+#define COMMAND_PROGRAM_H
+#include "Command_reader.h"
+#include "Ship_handle.h"
+#include <string>
+#include <vector>
+#include <map>
+#include <memory>
+
+class Ship;
+class Island;
+
+// what the compiler knows about a command: the handler's index in the jump table,
+// and the kinds of its operands in order - w word, d double, n integer, i island,
+// or r the rest of the line, which is never compiled
+struct Command_signature {
+  int opcode;
+  std::string operands;
+};
+using Command_signatures = std::map<std::string, Command_signature>;
+
+class Command_program {
+public:
+  enum class Kind {GENERAL, SHIP, QUIT, INTERPRET};
+
+  struct Instruction {
+    Kind kind;
+    int opcode;           // the handler for a GENERAL or SHIP instruction
+    int symbol;           // the symbol of the line's first word
+    int first_operand;    // the operands are [first_operand, end_operand)
+    int end_operand;
+    const char* text;     // the line's first word in the script
+  };
+
+  struct Operand {
+    char kind;            // as in Command_signature
+    double number;        // a d operand
+    int integer;          // an n operand, or the index of a w or i operand's value
+  };
+
+  static const int NO_INSTRUCTION = -1;
+
+  // compile the script text in [begin, end); the text must outlive the program
+  Command_program(const char* begin, const char* end,
+    const Command_signatures& commands, const Command_signatures& ship_commands);
+
+  int size() const {return int(instructions.size());}
+  const Instruction& operator[] (int i) const {return instructions[i];}
+
+  // the index of the instruction whose line starts with the word at text, or NO_INSTRUCTION
+  int find_instruction(const char* text) const;
+
+  // the ship currently named by the symbol, or nullptr if there is none
+  std::shared_ptr<Ship> get_ship(int symbol);
+
+private:
+  friend class Program_reader;
+
+  struct Symbol {
+    std::string name;
+    unsigned version;             // the Model's ships version when ship was looked up
+    Ship_handle ship;
+  };
+
+  std::vector<Instruction> instructions;
+  std::vector<Operand> operands;
+  std::vector<std::string> words;
+  std::vector<std::shared_ptr<Island>> islands;
+  std::vector<Symbol> symbols;
+  std::map<std::string, int> symbol_indices;
+
+  // the symbol for the name, interning it if new
+  int intern(const std::string& name);
+  // append the tokens as operands of the given kinds; return false, leaving
+  // no operands behind, if they do not match
+  bool compile_operands(const std::vector<std::string>& tokens, std::size_t first, const std::string& kinds);
+};
+
+// Program_reader supplies a compiled instruction's operands to its handler
+class Program_reader : public Command_reader {
+public:
+  Program_reader(const Command_program& program_, const Command_program::Instruction& instruction);
+  bool read_word(std::string& word) override;
+  bool read_double(double& value) override;
+  bool read_int(int& value) override;
+  bool read_island(std::shared_ptr<Island>& island) override;
+  // an instruction is a whole line, so there is nothing else to skip or read
+  void skip_line() override {}
+  bool read_keyword(const char*) override {return false;}
+  void read_line(std::string& text) override {text.clear();}
+
+private:
+  const Command_program& program;
+  int next;   // the index of the next operand
+  int end;
+};
+
+#endif
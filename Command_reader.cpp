@@ -0,0 +1,358 @@
+#include "Command_reader.h"
+#include "Utility.h"
+#include "Island.h"
+#include <istream>
+#include <string>
+#include <climits>
+#include <cstdlib>
+#include <cerrno>
+#include <cmath>
+#include <cstdio>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+using std::string;
+using std::istream;
+
+// the characters an istream skips as whitespace in the "C" locale
+bool is_command_space(char c)
+{
+  return c == ' ' || c == '\n' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
+}
+
+static bool is_digit(char c)
+{
+  return c >= '0' && c <= '9';
+}
+
+// powers of ten that are exact doubles
+static const double exact_powers[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9,
+  1e10, 1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+
+// Consume [sign] digits [. digits] [e [sign] digits] as an istream does, then convert.
+// When the significant digits fit in 53 bits and the power of ten is exact, one
+// multiplication or division gives the correctly rounded value; otherwise strtod does.
+bool parse_double(const char*& p, const char* end, double& value)
+{
+  const char* start = p;
+  bool negative = false;
+  if (p < end && (*p == '+' || *p == '-')) {
+    negative = (*p == '-');
+    ++p;
+  }
+  unsigned long long mantissa = 0;
+  int digits = 0;       // significant digits accumulated in mantissa
+  int fraction = 0;     // fraction digits accumulated in mantissa
+  bool has_digits = false, has_point = false;
+  for (; p < end; ++p) {
+    if (is_digit(*p)) {
+      has_digits = true;
+      if (mantissa == 0 && *p == '0') {
+        if (has_point) ++fraction;
+        continue;
+      }
+      // past 19 digits the mantissa exceeds 53 bits, and strtod converts instead
+      if (digits < 19) {
+        mantissa = mantissa * 10 + (*p - '0');
+        ++digits;
+        if (has_point) ++fraction;
+      }
+    } else if (*p == '.' && !has_point) {
+      has_point = true;
+    } else {
+      break;
+    }
+  }
+  int exponent = 0;
+  if (has_digits && p < end && (*p == 'e' || *p == 'E')) {
+    ++p;
+    bool exponent_negative = false;
+    if (p < end && (*p == '+' || *p == '-')) {
+      exponent_negative = (*p == '-');
+      ++p;
+    }
+    if (p == end || !is_digit(*p)) return false; // "1e" or "1e+" is not a number
+    for (; p < end && is_digit(*p); ++p) {
+      if (exponent < 100000) exponent = exponent * 10 + (*p - '0');
+    }
+    if (exponent_negative) exponent = -exponent;
+  }
+  if (!has_digits) return false;
+  int power = exponent - fraction;
+  bool exact = mantissa <= (1ULL << 53);
+  if (exact && mantissa == 0) {
+    value = 0.;
+  } else if (exact && power >= 0 && power <= 22) {
+    value = double(mantissa) * exact_powers[power];
+  } else if (exact && power < 0 && power >= -22) {
+    value = double(mantissa) / exact_powers[-power];
+  } else {
+    string text(start, p);
+    errno = 0;
+    value = strtod(text.c_str(), nullptr);
+    if (errno == ERANGE && std::isinf(value)) return false;
+    return true;
+  }
+  if (negative) value = -value;
+  return true;
+}
+
+// Consume [sign] digits as an istream does; out of range is a failure
+bool parse_int(const char*& p, const char* end, int& value)
+{
+  bool negative = false;
+  if (p < end && (*p == '+' || *p == '-')) {
+    negative = (*p == '-');
+    ++p;
+  }
+  if (p == end || !is_digit(*p)) return false;
+  long long result = 0;
+  bool overflow = false;
+  for (; p < end && is_digit(*p); ++p) {
+    result = result * 10 + (*p - '0');
+    if (result > (long long)INT_MAX + 1) {
+      overflow = true;
+      result = (long long)INT_MAX + 1;
+    }
+  }
+  if (negative) result = -result;
+  if (overflow || result > INT_MAX || result < INT_MIN) return false;
+  value = int(result);
+  return true;
+}
+
+Stream_reader::Stream_reader(istream& is_)
+  :is(is_)
+{}
+
+bool Stream_reader::read_word(string& word)
+{
+  if (!pending.empty()) {
+    word.swap(pending);
+    pending.clear();
+    return true;
+  }
+  return bool(is >> word);
+}
+
+// a number is read from the front of a pending word as the stream would read it
+bool Stream_reader::read_double(double& value)
+{
+  if (!pending.empty()) {
+    const char* p = pending.data();
+    bool valid = parse_double(p, p + pending.size(), value);
+    pending.erase(0, p - pending.data());
+    return valid;
+  }
+  return bool(is >> value);
+}
+
+bool Stream_reader::read_int(int& value)
+{
+  if (!pending.empty()) {
+    const char* p = pending.data();
+    bool valid = parse_int(p, p + pending.size(), value);
+    pending.erase(0, p - pending.data());
+    return valid;
+  }
+  return bool(is >> value);
+}
+
+// clear a failed read, then discard the rest of the line
+void Stream_reader::skip_line()
+{
+  pending.clear();
+  if (is.fail()) is.clear();
+  while (is && is.get() != '\n');
+}
+
+bool Stream_reader::read_keyword(const char* keyword)
+{
+  if (pending.empty()) {
+    int c = skip_blanks();
+    if (c == EOF || c == '\n' || !(is >> pending)) return false;
+  }
+  if (pending != keyword) return false;
+  pending.clear();
+  return true;
+}
+
+void Stream_reader::read_line(string& text)
+{
+  text.swap(pending);
+  pending.clear();
+  int c = text.empty() ? skip_blanks() : is.peek();
+  for (; c != EOF && c != '\n'; c = is.peek()) text += char(is.get());
+}
+
+// read past whitespace other than newlines; return the next character, or EOF
+int Stream_reader::skip_blanks()
+{
+  int c;
+  while ((c = is.peek()) != EOF && c != '\n' && is_command_space(char(c))) is.get();
+  return c;
+}
+
+// map the file into memory
+Script_reader::Script_reader(const string& filename)
+  :begin(nullptr), end(nullptr), pos(nullptr), length(0)
+{
+  int fd = open(filename.c_str(), O_RDONLY);
+  if (fd < 0)
+    throw Error("Cannot open script file!");
+  struct stat info;
+  if (fstat(fd, &info) < 0) {
+    close(fd);
+    throw Error("Cannot open script file!");
+  }
+  length = info.st_size;
+  if (length > 0) {
+    void* mapping = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (mapping == MAP_FAILED) {
+      close(fd);
+      throw Error("Cannot open script file!");
+    }
+    madvise(mapping, length, MADV_SEQUENTIAL);
+    begin = static_cast<const char*>(mapping);
+  }
+  close(fd);
+  end = begin + length;
+  pos = begin;
+}
+
+// read the text in [begin_, end_), which must outlive the reader
+Script_reader::Script_reader(const char* begin_, const char* end_)
+  :begin(begin_), end(end_), pos(begin_), length(0)
+{}
+
+Script_reader::~Script_reader()
+{
+  if (length > 0)
+    munmap(const_cast<char*>(begin), length);
+}
+
+bool Script_reader::read_word(string& word)
+{
+  skip_whitespace();
+  if (pos == end) return false;
+  const char* start = pos;
+  while (pos < end && !is_command_space(*pos)) ++pos;
+  word.assign(start, pos);
+  return true;
+}
+
+bool Script_reader::read_double(double& value)
+{
+  skip_whitespace();
+  return parse_double(pos, end, value);
+}
+
+bool Script_reader::read_int(int& value)
+{
+  skip_whitespace();
+  return parse_int(pos, end, value);
+}
+
+void Script_reader::skip_line()
+{
+  while (pos < end && *pos++ != '\n');
+}
+
+bool Script_reader::read_keyword(const char* keyword)
+{
+  skip_blanks();
+  const char* p = pos;
+  for (; *keyword; ++keyword, ++p) {
+    if (p == end || *p != *keyword) return false;
+  }
+  if (p < end && !is_command_space(*p)) return false;
+  pos = p;
+  return true;
+}
+
+void Script_reader::read_line(string& text)
+{
+  skip_blanks();
+  const char* start = pos;
+  while (pos < end && *pos != '\n') ++pos;
+  text.assign(start, pos);
+}
+
+// the position in the text of the next word
+const char* Script_reader::next_word()
+{
+  skip_whitespace();
+  return pos;
+}
+
+// advance pos past whitespace
+void Script_reader::skip_whitespace()
+{
+  while (pos < end && is_command_space(*pos)) ++pos;
+}
+
+// advance pos past whitespace other than newlines
+void Script_reader::skip_blanks()
+{
+  while (pos < end && *pos != '\n' && is_command_space(*pos)) ++pos;
+}
+
+// record what is read from source_, after the words that started the command
+Recording_reader::Recording_reader(Command_reader& source_, const string& start)
+  :source(source_), text(start)
+{}
+
+bool Recording_reader::read_word(string& word)
+{
+  if (!source.read_word(word)) return false;
+  text += ' ';
+  text += word;
+  return true;
+}
+
+bool Recording_reader::read_double(double& value)
+{
+  if (!source.read_double(value)) return false;
+  // 17 significant digits read back as the same double
+  char number[32];
+  snprintf(number, sizeof(number), " %.17g", value);
+  text += number;
+  return true;
+}
+
+bool Recording_reader::read_int(int& value)
+{
+  if (!source.read_int(value)) return false;
+  text += ' ';
+  text += std::to_string(value);
+  return true;
+}
+
+bool Recording_reader::read_island(std::shared_ptr<Island>& island)
+{
+  if (!source.read_island(island)) return false;
+  text += ' ';
+  text += island->get_name();
+  return true;
+}
+
+void Recording_reader::skip_line()
+{
+  source.skip_line();
+}
+
+bool Recording_reader::read_keyword(const char* keyword)
+{
+  if (!source.read_keyword(keyword)) return false;
+  text += ' ';
+  text += keyword;
+  return true;
+}
+
+void Recording_reader::read_line(string& line)
+{
+  source.read_line(line);
+  text += ' ';
+  text += line;
+}
@@ -0,0 +1,132 @@
+/* Command_reader
+A Command_reader supplies the Controller with the words and numbers of commands.
+Reading follows the rules of reading from an istream with >>: leading whitespace
+is skipped, a number is read from the longest prefix that looks like one, and a
+failed read leaves the rest of the input in place, so that skip_line() discards
+the remainder of the line just as the interactive error handling always has.
+
+Stream_reader reads from an istream, normally cin. Script_reader maps a script file
+into memory and tokenizes it in place, parsing numbers without going through the
+stream or locale machinery. Recording_reader passes on what another reader reads,
+and keeps it as the text of the command.
+*/
+#ifndef COMMAND_READER_H
+#define COMMAND_READER_H
+#include <string>
+#include <iosfwd>
+#include <memory>
+
+class Island;
+
+class Command_reader {
+public:
+  virtual ~Command_reader() {}
+
+  // read the next whitespace-delimited word; return false at the end of input
+  virtual bool read_word(std::string& word) = 0;
+  // read a double; return false if the input does not start with one
+  virtual bool read_double(double& value) = 0;
+  // read an int; return false if the input does not start with one
+  virtual bool read_int(int& value) = 0;
+  // discard the input up to and including the next newline
+  virtual void skip_line() = 0;
+  // if the next word is on this line and is the keyword, read it and return true;
+  // otherwise return false, having read no more than the blanks before it
+  virtual bool read_keyword(const char* keyword) = 0;
+  // read the rest of this line from its next word on, leaving its newline
+  virtual void read_line(std::string& text) = 0;
+  // supply the next operand as an island resolved in advance; return false,
+  // consuming nothing, if the reader has no island there
+  virtual bool read_island(std::shared_ptr<Island>&) {return false;}
+};
+
+class Stream_reader : public Command_reader {
+public:
+  Stream_reader(std::istream& is_);
+  bool read_word(std::string& word) override;
+  bool read_double(double& value) override;
+  bool read_int(int& value) override;
+  void skip_line() override;
+  bool read_keyword(const char* keyword) override;
+  void read_line(std::string& text) override;
+
+private:
+  std::istream& is;
+  // a word read to compare with a keyword, which is read again from here;
+  // an istream cannot put back a whole word
+  std::string pending;
+
+  // read past whitespace other than newlines; return the next character, or EOF
+  int skip_blanks();
+};
+
+class Script_reader : public Command_reader {
+public:
+  // map the file into memory
+  // will throw Error("Cannot open script file!")
+  Script_reader(const std::string& filename);
+  // read the text in [begin_, end_), which must outlive the reader
+  Script_reader(const char* begin_, const char* end_);
+  ~Script_reader();
+  bool read_word(std::string& word) override;
+  bool read_double(double& value) override;
+  bool read_int(int& value) override;
+  void skip_line() override;
+  bool read_keyword(const char* keyword) override;
+  void read_line(std::string& text) override;
+
+  // the mapped text, and the position in it of the next word
+  const char* get_begin() const {return begin;}
+  const char* get_end() const {return end;}
+  const char* next_word();
+  // continue reading from position, which must be in the mapped text
+  void set_position(const char* position) {pos = position;}
+
+  // disallow copy/move construction or assignment
+  Script_reader(const Script_reader&) = delete;
+  Script_reader(Script_reader&&) = delete;
+  Script_reader& operator= (const Script_reader&) = delete;
+  Script_reader& operator= (Script_reader&&) = delete;
+
+private:
+  const char* begin; // the mapped file
+  const char* end;
+  const char* pos;   // the next character to read
+  std::size_t length; // the size of the mapping, 0 if none
+
+  // advance pos past whitespace
+  void skip_whitespace();
+  // advance pos past whitespace other than newlines
+  void skip_blanks();
+};
+
+class Recording_reader : public Command_reader {
+public:
+  // record what is read from source_, after the words that started the command
+  Recording_reader(Command_reader& source_, const std::string& start);
+  bool read_word(std::string& word) override;
+  bool read_double(double& value) override;
+  bool read_int(int& value) override;
+  bool read_island(std::shared_ptr<Island>& island) override;
+  void skip_line() override;
+  bool read_keyword(const char* keyword) override;
+  void read_line(std::string& text) override;
+
+  // the command read so far, on one line, with numbers that read back exactly
+  const std::string& get_text() const {return text;}
+
+private:
+  Command_reader& source;
+  std::string text;
+};
+
+/* Number parsing shared by the readers that work on characters in memory.
+Each consumes from p the longest prefix an istream would take for that kind of
+number, and returns false, with p after the consumed characters, if the prefix
+is not a valid number. */
+bool parse_double(const char*& p, const char* end, double& value);
+bool parse_int(const char*& p, const char* end, int& value);
+// the characters that separate words
+bool is_command_space(char c);
+
+#endif
@@ -0,0 +1,296 @@
+#include "Command_server.h"
+#include "Utility.h"
+#include <csignal>
+#include <cerrno>
+#include <cstring>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+using std::string;
+using std::vector;
+using std::pair;
+
+// set by SIGINT, SIGTERM or stop; the wake eventfd then ends the wait
+static volatile std::sig_atomic_t stop_requested = 0;
+static int signal_wake_fd = -1;
+
+static void request_stop(int)
+{
+  stop_requested = 1;
+  uint64_t one = 1;
+  if (signal_wake_fd >= 0 && write(signal_wake_fd, &one, sizeof(one)) < 0) {}
+}
+
+// the epoll data of the listening socket and of the wake eventfd; client ids start after them
+static const int LISTEN_ID = 0;
+static const int WAKE_ID = 1;
+// the most events taken from epoll at once
+static const int MAX_EVENTS = 64;
+// the most bytes read from a client at once
+static const int READ_SIZE = 65536;
+
+// listen at the socket path, replacing any socket file left there
+Command_server::Command_server(const string& path_)
+  :path(path_), listen_fd(-1), epoll_fd(-1), wake_fd(-1), next_id(WAKE_ID + 1)
+{
+  sockaddr_un address;
+  std::memset(&address, 0, sizeof(address));
+  address.sun_family = AF_UNIX;
+  if (path.size() >= sizeof(address.sun_path))
+    throw Error("Cannot start server!");
+  std::strcpy(address.sun_path, path.c_str());
+  unlink(path.c_str());
+  listen_fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+  epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+  wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  epoll_event event, wake_event;
+  event.events = EPOLLIN;
+  event.data.u64 = LISTEN_ID;
+  wake_event.events = EPOLLIN;
+  wake_event.data.u64 = WAKE_ID;
+  if (listen_fd < 0 || epoll_fd < 0 || wake_fd < 0 ||
+      bind(listen_fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0 ||
+      listen(listen_fd, SOMAXCONN) < 0 ||
+      epoll_ctl(epoll_fd, EPOLL_CTL_ADD, listen_fd, &event) < 0 ||
+      epoll_ctl(epoll_fd, EPOLL_CTL_ADD, wake_fd, &wake_event) < 0) {
+    if (listen_fd >= 0) close(listen_fd);
+    if (epoll_fd >= 0) close(epoll_fd);
+    if (wake_fd >= 0) close(wake_fd);
+    throw Error("Cannot start server!");
+  }
+  signal_wake_fd = wake_fd;
+  // a signal interrupts the wait instead of ending the program,
+  // and a client that goes away shows up as a failed send
+  struct sigaction action;
+  std::memset(&action, 0, sizeof(action));
+  action.sa_handler = request_stop;
+  sigemptyset(&action.sa_mask);
+  sigaction(SIGINT, &action, nullptr);
+  sigaction(SIGTERM, &action, nullptr);
+  signal(SIGPIPE, SIG_IGN);
+}
+
+// disconnect every client and remove the socket file
+Command_server::~Command_server()
+{
+  signal_wake_fd = -1;
+  for (auto& client : clients) {
+    close(client.second.fd);
+  }
+  close(wake_fd);
+  close(epoll_fd);
+  close(listen_fd);
+  unlink(path.c_str());
+}
+
+// wait until some client has complete command lines;
+// return false if the server has been stopped
+bool Command_server::wait_for_commands()
+{
+  epoll_event events[MAX_EVENTS];
+  while (!stop_requested) {
+    {
+      std::lock_guard<std::mutex> lock(clients_mutex);
+      for (auto& client : clients) {
+        if (has_commands(client.second)) return true;
+      }
+    }
+    int count = epoll_wait(epoll_fd, events, MAX_EVENTS, -1);
+    if (count < 0) {
+      if (errno == EINTR) continue;
+      throw Error("Cannot wait for clients!");
+    }
+    std::lock_guard<std::mutex> lock(clients_mutex);
+    for (int i = 0; i < count; ++i) {
+      int id = int(events[i].data.u64);
+      if (id == WAKE_ID) {
+        uint64_t value;
+        if (read(wake_fd, &value, sizeof(value)) < 0) {}
+        continue;
+      }
+      if (id == LISTEN_ID) {
+        accept_clients();
+        continue;
+      }
+      auto it = clients.find(id);
+      if (it == clients.end()) continue;
+      // after a hangup or an error the rest of the input is read and the output
+      // flushed, which closes the input and drops the client from the epoll set
+      if (events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR))
+        receive(id, it->second);
+      if (events[i].events & (EPOLLOUT | EPOLLHUP | EPOLLERR))
+        flush(id, it->second);
+      check_done(id);
+    }
+  }
+  return false;
+}
+
+// take the complete command lines of each client, as client id and lines,
+// in order of connection
+vector<pair<int, string>> Command_server::take_commands()
+{
+  std::lock_guard<std::mutex> lock(clients_mutex);
+  vector<pair<int, string>> commands;
+  for (auto& client : clients) {
+    string& input = client.second.input;
+    if (client.second.closing) continue;
+    string::size_type end = input.rfind('\n');
+    if (end == string::npos) continue;
+    commands.emplace_back(client.first, input.substr(0, end + 1));
+    input.erase(0, end + 1);
+    ++client.second.unfinished;
+  }
+  return commands;
+}
+
+// send the output of taken command lines to the client, finishing them
+void Command_server::finish_commands(int id, const string& output)
+{
+  std::lock_guard<std::mutex> lock(clients_mutex);
+  auto it = clients.find(id);
+  if (it == clients.end()) return;
+  --it->second.unfinished;
+  it->second.output += output;
+  flush(id, it->second);
+  check_done(id);
+}
+
+// send the text to the client
+void Command_server::send(int id, const string& text)
+{
+  std::lock_guard<std::mutex> lock(clients_mutex);
+  auto it = clients.find(id);
+  if (it == clients.end()) return;
+  it->second.output += text;
+  flush(id, it->second);
+  check_done(id);
+}
+
+// disconnect the client once its output has been sent
+void Command_server::close_client(int id)
+{
+  std::lock_guard<std::mutex> lock(clients_mutex);
+  auto it = clients.find(id);
+  if (it == clients.end()) return;
+  it->second.closing = true;
+  check_done(id);
+}
+
+// false once the client has quit or gone away
+bool Command_server::is_connected(int id)
+{
+  std::lock_guard<std::mutex> lock(clients_mutex);
+  auto it = clients.find(id);
+  return it != clients.end() && !it->second.closing;
+}
+
+// stop the server, ending the wait for commands
+void Command_server::stop()
+{
+  stop_requested = 1;
+  uint64_t one = 1;
+  if (write(wake_fd, &one, sizeof(one)) < 0) {}
+}
+
+// accept every pending connection
+void Command_server::accept_clients()
+{
+  while (true) {
+    int fd = accept4(listen_fd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+    if (fd < 0) return;
+    int id = next_id++;
+    epoll_event event;
+    event.events = EPOLLIN;
+    event.data.u64 = id;
+    if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &event) < 0) {
+      close(fd);
+      continue;
+    }
+    Client client = {fd, string(), string(), false, false, 0, true};
+    clients[id] = client;
+  }
+}
+
+// read what the client has sent
+void Command_server::receive(int id, Client& client)
+{
+  char buffer[READ_SIZE];
+  while (!client.input_closed) {
+    ssize_t count = read(client.fd, buffer, sizeof(buffer));
+    if (count > 0) {
+      client.input.append(buffer, count);
+    } else if (count < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+      return;
+    } else if (count < 0 && errno == EINTR) {
+      continue;
+    } else {
+      // the last line counts even without its newline
+      client.input_closed = true;
+      if (!client.input.empty() && client.input.back() != '\n')
+        client.input += '\n';
+      // stop watching for input, so that the end of it does not wake the wait again
+      watch(id, client);
+    }
+  }
+}
+
+// send as much of the output as the socket takes, and watch for the socket
+// becoming writable if some is left
+void Command_server::flush(int id, Client& client)
+{
+  while (!client.output.empty()) {
+    ssize_t count = ::send(client.fd, client.output.data(), client.output.size(), MSG_NOSIGNAL);
+    if (count > 0) {
+      client.output.erase(0, count);
+    } else if (count < 0 && errno == EINTR) {
+      continue;
+    } else if (count < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+      break;
+    } else {
+      // the client is gone, and so is its output
+      client.output.clear();
+      client.input_closed = true;
+      client.closing = true;
+      break;
+    }
+  }
+  watch(id, client);
+}
+
+// watch the socket for what the client is waiting on; once it is neither sending
+// nor being sent anything, take it out of the epoll set, since a hangup cannot be masked
+void Command_server::watch(int id, Client& client)
+{
+  epoll_event event;
+  event.events = (client.input_closed ? 0 : EPOLLIN) | (client.output.empty() ? 0 : EPOLLOUT);
+  event.data.u64 = id;
+  if (!event.events) {
+    if (client.watched) epoll_ctl(epoll_fd, EPOLL_CTL_DEL, client.fd, &event);
+    client.watched = false;
+  } else {
+    epoll_ctl(epoll_fd, client.watched ? EPOLL_CTL_MOD : EPOLL_CTL_ADD, client.fd, &event);
+    client.watched = true;
+  }
+}
+
+// disconnect the client if it is done
+void Command_server::check_done(int id)
+{
+  auto it = clients.find(id);
+  if (it == clients.end()) return;
+  Client& client = it->second;
+  bool finished = client.closing || (client.input_closed && !has_commands(client));
+  if (finished && !client.unfinished && client.output.empty()) {
+    close(client.fd);
+    clients.erase(it);
+  }
+}
+
+// true if the client has a complete line waiting
+bool Command_server::has_commands(const Client& client)
+{
+  return !client.closing && client.input.find('\n') != string::npos;
+}
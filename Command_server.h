@@ -0,0 +1,95 @@
+/* Command_server
+A Command_server lets several clients drive the simulation at once over a Unix
+domain socket. It accepts any number of connections, and multiplexes them with epoll.
+Each client sends command lines and gets back only the output of its own commands.
+
+The server does not run commands itself. One thread waits for commands and takes
+them in rounds, while another may send output and close clients. Each round holds
+every complete line received so far, taken in order of connection.
+
+The Controller queues each client's lines to the Model under the client's id, and
+the Model applies them only at tick boundaries. A boundary runs every batch queued
+before it in order of client id, which is the order of connection, and the batches
+of one client in the order received. So one client's batches never interleave with
+another's within a boundary, however their bytes arrived. Lines that arrive while
+a boundary's batches run, including during a go among them, wait for the next
+boundary.
+
+A client that sends quit, or closes its end of the connection, is disconnected once
+its output has been sent. SIGINT or SIGTERM, or a call to stop, stops the server.
+*/
+#ifndef COMMAND_SERVER_H
+#define COMMAND_SERVER_H
+#include <string>
+#include <vector>
+#include <map>
+#include <utility>
+#include <mutex>
+
+class Command_server {
+public:
+  // listen at the socket path, replacing any socket file left there
+  // will throw Error("Cannot start server!")
+  Command_server(const std::string& path_);
+  // disconnect every client and remove the socket file
+  ~Command_server();
+
+  // wait until some client has complete command lines;
+  // return false if the server has been stopped
+  bool wait_for_commands();
+  // take the complete command lines of each client, as client id and lines,
+  // in order of connection; the client stays connected until they are finished
+  std::vector<std::pair<int, std::string>> take_commands();
+  // send the output of taken command lines to the client, finishing them
+  void finish_commands(int id, const std::string& output);
+  // send the text to the client
+  void send(int id, const std::string& text);
+  // disconnect the client once its output has been sent
+  void close_client(int id);
+  // false once the client has quit or gone away
+  bool is_connected(int id);
+  // stop the server, ending the wait for commands
+  void stop();
+
+  // disallow copy/move construction or assignment
+  Command_server(const Command_server&) = delete;
+  Command_server(Command_server&&) = delete;
+  Command_server& operator= (const Command_server&) = delete;
+  Command_server& operator= (Command_server&&) = delete;
+
+private:
+  struct Client {
+    int fd;
+    std::string input;    // received text not yet taken
+    std::string output;   // text not yet sent
+    bool input_closed;    // the client will send nothing more
+    bool closing;         // disconnect once the output is sent
+    int unfinished;       // the taken batches of lines not yet finished
+    bool watched;         // the socket is in the epoll set
+  };
+
+  std::string path;
+  int listen_fd;
+  int epoll_fd;
+  int wake_fd;                       // an eventfd that ends the wait when written
+  int next_id;                       // ids are never reused, and order the clients
+  std::map<int, Client> clients;     // client id to client
+  std::mutex clients_mutex;          // guards clients
+
+  // accept every pending connection
+  void accept_clients();
+  // read what the client has sent
+  void receive(int id, Client& client);
+  // send as much of the output as the socket takes, and watch for the socket
+  // becoming writable if some is left
+  void flush(int id, Client& client);
+  // watch the socket for what the client is waiting on; once it is neither sending
+  // nor being sent anything, take it out of the epoll set, since a hangup cannot be masked
+  void watch(int id, Client& client);
+  // disconnect the client if it is done
+  void check_done(int id);
+  // true if the client has a complete line waiting
+  static bool has_commands(const Client& client);
+};
+
+#endif
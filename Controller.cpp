@@ -3,16 +3,27 @@
 #include "View.h"
 #include "Views.h"
 #include "Ship.h"
+#include "Tanker.h"
 #include "Island.h"
 #include "Geometry.h"
 #include "Ship_factory.h"
 #include "Utility.h"
+#include "Command_reader.h"
+#include "Command_program.h"
+#include "Command_server.h"
+#include "Command_journal.h"
+#include "Logistics.h"
+#include "Metrics.h"
 #include <iostream>
+#include <sstream>
+#include <thread>
+#include <typeinfo>
 #include <string>
 #include <vector>
 #include <map>
 #include <functional>
 #include <algorithm>
+#include <cmath>
 using std::cin;
 using std::cout;
 using std::endl;
@@ -21,128 +32,635 @@ using std::map;
 using std::vector;
 using std::shared_ptr;
 
+// set up the command tables
+Controller::Controller()
+  :reader(nullptr), rejection(nullptr), logistics_task(0)
+{
+  // general commands for view and model, with the kinds of their operands
+  add_command("status", &Controller::status, "");
+  add_command("go", &Controller::go, "");
+  add_command("when", &Controller::when, "r");
+  add_command("create", &Controller::create, "wwdd");
+  add_command("create_fleet", &Controller::create_fleet, "wwnddd");
+  add_command("show", &Controller::show, "");
+  add_command("stats", &Controller::stats, "");
+  add_command("stats_dump", &Controller::stats_dump, "wn");
+  add_command("stats_dump_stop", &Controller::stats_dump_stop, "");
+  add_command("logistics", &Controller::start_logistics, "r");
+  add_command("logistics_stop", &Controller::stop_logistics, "");
+  add_command("fuel_policy", &Controller::fuel_policy, "iw");
+  add_command("berths", &Controller::berths, "i");
+  add_command("open_map_view", &Controller::open_map_view, "");
+  add_command("close_map_view", &Controller::close_map_view, "");
+  add_command("open_sailing_view", &Controller::open_sailing_view, "");
+  add_command("close_sailing_view", &Controller::close_sailing_view, "");
+  add_command("open_bridge_view", &Controller::open_bridge_view, "w");
+  add_command("close_bridge_view", &Controller::close_bridge_view, "w");
+  add_command("display", &Controller::display, "w");
+  add_command("open_density_view", &Controller::open_density_view, "");
+  add_command("close_density_view", &Controller::close_density_view, "");
+  add_command("open_telemetry_view", &Controller::open_telemetry_view, "ww");
+  add_command("close_telemetry_view", &Controller::close_telemetry_view, "");
+  add_command("default", &Controller::view_default, "");
+  add_command("size", &Controller::view_size, "n");
+  add_command("zoom", &Controller::view_zoom, "d");
+  add_command("pan", &Controller::view_pan, "dd");
+  add_command("density_default", &Controller::density_default, "");
+  add_command("density_size", &Controller::density_size, "n");
+  add_command("density_zoom", &Controller::density_zoom, "d");
+  add_command("density_pan", &Controller::density_pan, "dd");
+  add_command("density_style", &Controller::density_style, "w");
+  add_command("density_filter", &Controller::density_filter, "w");
+  // ship commands
+  add_ship_command("course", &Controller::ship_course, "dd");
+  add_ship_command("position", &Controller::ship_position, "ddd");
+  add_ship_command("destination", &Controller::ship_destination, "id");
+  add_ship_command("load_at", &Controller::ship_load_at, "i");
+  add_ship_command("unload_at", &Controller::ship_unload_at, "i");
+  add_ship_command("dock_at", &Controller::ship_dock_at, "i");
+  add_ship_command("attack", &Controller::ship_attack, "w");
+  add_ship_command("refuel", &Controller::ship_refuel, "");
+  add_ship_command("stop", &Controller::ship_stop, "");
+  add_ship_command("stop_attack", &Controller::ship_stop_attack, "");
+  add_ship_command("itinerary", &Controller::ship_itinerary, "w");
+  add_ship_command("patrol", &Controller::ship_patrol, "dddd");
+}
+
+// the journal is completed when destroyed
+Controller::~Controller()
+{}
+
 // create View object, run the program by acccepting user commands, then destroy View object
 void Controller::run()
 {
-  // general commands for view and model
-  map<string, void(Controller::*)()> commands = { //NOTE: CAN MAKE THESE TWO MEMBER VARIABLE
-    {"status", &Controller::status}, 
-    {"go", &Controller::go}, 
-    {"create", &Controller::create}, 
-    {"show", &Controller::show},
-    {"open_map_view", &Controller::open_map_view}, 
-    {"close_map_view", &Controller::close_map_view}, 
-    {"open_sailing_view", &Controller::open_sailing_view}, 
-    {"close_sailing_view", &Controller::close_sailing_view},
-    {"open_bridge_view", &Controller::open_bridge_view}, 
-    {"close_bridge_view", &Controller::close_bridge_view},
-    {"default", &Controller::view_default}, 
-    {"size", &Controller::view_size}, 
-    {"zoom", &Controller::view_zoom}, 
-    {"pan", &Controller::view_pan}
-  };
-  // ship commands
-  map<string, void(Controller::*)(shared_ptr<Ship>)> ship_commands = {
-    {"course", &Controller::ship_course}, {"position", &Controller::ship_position}, {"destination", &Controller::ship_destination},
-    {"load_at", &Controller::ship_load_at}, {"unload_at", &Controller::ship_unload_at}, {"dock_at", &Controller::ship_dock_at},
-    {"attack", &Controller::ship_attack}, {"refuel", &Controller::ship_refuel}, {"stop", &Controller::ship_stop}, 
-    {"stop_attack", &Controller::ship_stop_attack}
-  };
+  Stream_reader stream_reader(cin);
+  run_commands(stream_reader, true);
+}
+
+// run the commands in the script file without prompting
+void Controller::run_script(const string& filename)
+{
+  try {
+    Script_reader script_reader(filename);
+    run_commands(script_reader, false);
+  } catch (Error& e) {
+    cout << e.what() << endl;
+  }
+}
+
+// run the script compiled to a Command_program, interpreting the lines that did not compile
+void Controller::run_compiled(const string& filename)
+{
+  try {
+    Script_reader script_reader(filename);
+    Command_program program(script_reader.get_begin(), script_reader.get_end(), commands, ship_commands);
+    // the end of the input quits
+    if (run_program(program, script_reader)) quit();
+  } catch (Error& e) {
+    cout << e.what() << endl;
+  }
+}
+
+// replay the journal with the output muted before the tick, then accept user commands
+void Controller::run_replay(const string& filename, int unmute_tick)
+{
+  try {
+    string text;
+    vector<int> ticks;
+    read_journal(filename, text, ticks);
+    // the lines of the commands applied before the tick end at split
+    auto unmuted = std::lower_bound(ticks.begin(), ticks.end(), unmute_tick);
+    string::size_type split = 0;
+    for (auto i = ticks.begin(); i != unmuted; ++i) {
+      split = text.find('\n', split) + 1;
+    }
+    cout.setstate(std::ios::badbit);
+    bool running = replay_commands(text.data(), text.data() + split);
+    cout.clear();
+    if (running) running = replay_commands(text.data() + split, text.data() + text.size());
+    if (!running) return;
+  } catch (Error& e) {
+    cout.clear();
+    cout << e.what() << endl;
+  }
+  run();
+}
+
+// start journaling the accepted commands to the file
+bool Controller::open_journal(const string& filename)
+{
+  try {
+    journal.reset(new Command_journal(filename));
+  } catch (Error& e) {
+    cout << e.what() << endl;
+    return false;
+  }
+  return true;
+}
+
+// serve the clients of a Command_server listening at the socket path until stopped by a signal
+void Controller::run_server(const string& path)
+{
+  try {
+    Command_server server(path);
+    Model& model = Model::get_Instance();
+    bool failed = false;
+    // take the clients' commands on a thread of their own, and queue them to the
+    // Model, which applies them here or at the start of the next tick, by client id
+    std::thread ingest([this, &server, &model, &failed] {
+      try {
+        while (server.wait_for_commands()) {
+          for (auto& commands : server.take_commands()) {
+            int id = commands.first;
+            string lines = std::move(commands.second);
+            model.enqueue_command(id, [this, &server, &failed, id, lines] {
+                if (!run_client_commands(server, id, lines)) {
+                  failed = true;
+                  server.stop();
+                }
+              },
+              [&server, id](const char* message) {server.send(id, string(message) + "\n");});
+          }
+        }
+      } catch (Error&) {
+        // the server can no longer wait for clients; stop as a signal would
+      }
+      model.close_command_queue();
+    });
+    while (model.wait_for_queued_commands()) {
+      model.apply_queued_commands();
+    }
+    ingest.join();
+    if (failed) return;
+  } catch (Error& e) {
+    cout << e.what() << endl;
+  }
+  quit();
+}
+
+// run a client's lines with its output sent back to it; a command must be on one line
+// return false if the program must end
+bool Controller::run_client_commands(Command_server& server, int id, const string& lines)
+{
+  // lines taken before the client quit are dropped
+  if (!server.is_connected(id)) {
+    server.finish_commands(id, string());
+    return true;
+  }
+  // a go among the lines leaves the commands queued meanwhile to the next boundary
+  Command_reader* saved_reader = reader;
+  std::istringstream input(lines);
+  Stream_reader stream_reader(input);
+  reader = &stream_reader;
+  std::ostringstream output;
+  std::streambuf* saved_buffer = cout.rdbuf(output.rdbuf());
   string word;
-  while (true) {
-    cout << "\nTime " << Model::get_Instance().get_time() << ": Enter command: ";
-    cin >> word;
-    try {
-      if (word == "quit") {
-        quit();
-        return;
-      } else if (Model::get_Instance().is_ship_present(word)) {
-        shared_ptr<Ship> ship = Model::get_Instance().get_ship_ptr(word);
-        // expect ship command
-        string instr;
-        cin >> instr;
-        auto fn = ship_commands.find(instr);
-        if (fn != ship_commands.end()) {
-          (this->*(fn->second))(ship);
+  bool client_quit = false, running = true;
+  while (running && stream_reader.read_word(word)) {
+    if (word == "quit") {
+      // only the client quits
+      cout << "Done" << endl;
+      client_quit = true;
+      break;
+    }
+    running = run_command(word);
+  }
+  cout.rdbuf(saved_buffer);
+  reader = saved_reader;
+  server.finish_commands(id, output.str());
+  if (client_quit) server.close_client(id);
+  return running;
+}
+
+// read and execute commands from reader_ until quit or the end of the input
+void Controller::run_commands(Command_reader& reader_, bool prompt)
+{
+  reader = &reader_;
+  string word;
+  do {
+    if (prompt) cout << "\nTime " << Model::get_Instance().get_time() << ": Enter command: ";
+    if (!reader->read_word(word)) {
+      // the end of the input quits
+      quit();
+      return;
+    }
+  } while (run_command(word));
+}
+
+// compile and run the commands in [begin, end); return false if the commands end with quit
+bool Controller::replay_commands(const char* begin, const char* end)
+{
+  Script_reader script_reader(begin, end);
+  Command_program program(begin, end, commands, ship_commands);
+  return run_program(program, script_reader);
+}
+
+// the first count words of the text
+static string leading_words(const char* text, const char* end, int count)
+{
+  const char* p = text;
+  for (int i = 0; i < count; ++i) {
+    while (p < end && is_command_space(*p)) ++p;
+    while (p < end && !is_command_space(*p)) ++p;
+  }
+  return string(text, p);
+}
+
+// execute the program; script_reader reads its text where it must be interpreted
+// return false if the commands end with quit
+bool Controller::run_program(Command_program& program, Script_reader& script_reader)
+{
+  int pc = 0;
+  while (pc < program.size()) {
+    const Command_program::Instruction& instruction = program[pc];
+    if (instruction.kind == Command_program::Kind::QUIT) {
+      quit();
+      return false;
+    }
+    // the first word decides between a ship command and any other command when it runs
+    shared_ptr<Ship> ship = program.get_ship(instruction.symbol);
+    if ((instruction.kind == Command_program::Kind::GENERAL && !ship) ||
+        (instruction.kind == Command_program::Kind::SHIP && ship)) {
+      Program_reader program_reader(program, instruction);
+      reader = &program_reader;
+      auto execute = [this, &instruction, &ship] {
+        long long start = Metrics::now();
+        if (ship) {
+          (this->*ship_command_handlers[instruction.opcode])(ship);
+          if (!rejection) ship_command_latencies[instruction.opcode]->record(Metrics::now() - start);
         } else {
-          throw Error("Unrecognized command!");
+          (this->*command_handlers[instruction.opcode])();
+          if (!rejection) command_latencies[instruction.opcode]->record(Metrics::now() - start);
         }
-      } else {
-        // expect command for model or view
-        auto fn = commands.find(word);
-        if (fn != commands.end()) {
-          (this->*(fn->second))();
+      };
+      try {
+        if (journal) {
+          int words = instruction.kind == Command_program::Kind::SHIP ? 2 : 1;
+          run_journaled(leading_words(instruction.text, script_reader.get_end(), words), execute);
         } else {
-          throw Error("Unrecognized command!");
+          execute();
         }
+        if (rejection) {
+          cout << rejection << endl;
+          rejection = nullptr;
+        }
+        Model::get_Instance().settle_fuel_requests();
+        Model::get_Instance().run_fired_triggers();
+      } catch (Error& e) {
+        cout << e.what() << endl;
+      } catch (std::exception& e2) {
+        cout << e2.what() << endl;
+        quit();
+        return false;
       }
-    } catch (Error& e) {
-      cout << e.what() << endl;
-      if (cin.fail()) cin.clear();
-      while (cin.get() != '\n');
-    } catch (std::exception& e2) { //NOTE: NO NEED TO HAVE A NEW NAME
-      cout << e2.what() << endl;
+      ++pc;
+      continue;
+    }
+    // interpret from this line until a command ends where a compiled line begins
+    reader = &script_reader;
+    script_reader.set_position(instruction.text);
+    string word;
+    do {
+      if (!reader->read_word(word)) return true;
+      if (!run_command(word)) return false;
+      pc = program.find_instruction(script_reader.next_word());
+    } while (pc == Command_program::NO_INSTRUCTION || program[pc].kind == Command_program::Kind::INTERPRET);
+  }
+  return true;
+}
+
+// execute the command that starts with word; return false if the commands end here
+bool Controller::run_command(const string& word)
+{
+  try {
+    if (word == "quit") {
       quit();
-      return;
-    } // NOTE: CATCH(...)
+      return false;
+    } else if (journal) {
+      run_journaled(word, [this, &word] {dispatch_command(word);});
+    } else {
+      dispatch_command(word);
+    }
+    // a rejected command is reported just as a thrown Error is, without the unwinding
+    if (rejection) {
+      cout << rejection << endl;
+      rejection = nullptr;
+      reader->skip_line();
+    }
+    Model::get_Instance().settle_fuel_requests();
+    Model::get_Instance().run_fired_triggers();
+  } catch (Error& e) {
+    cout << e.what() << endl;
+    reader->skip_line();
+  } catch (std::exception& e2) { //NOTE: NO NEED TO HAVE A NEW NAME
+    cout << e2.what() << endl;
+    quit();
+    return false;
+  } // NOTE: CATCH(...)
+  return true;
+}
+
+// execute the command that starts with word; a rejected command leaves rejection set
+void Controller::dispatch_command(const string& word)
+{
+  shared_ptr<Ship> ship = Model::get_Instance().find_ship(word);
+  if (ship) {
+    // expect ship command
+    string instr;
+    reader->read_word(instr);
+    auto fn = ship_commands.find(instr);
+    if (fn == ship_commands.end()) return reject("Unrecognized command!");
+    long long start = Metrics::now();
+    (this->*ship_command_handlers[fn->second.opcode])(ship);
+    if (!rejection) ship_command_latencies[fn->second.opcode]->record(Metrics::now() - start);
+  } else {
+    // expect command for model or view
+    auto fn = commands.find(word);
+    if (fn == commands.end()) return reject("Unrecognized command!");
+    long long start = Metrics::now();
+    (this->*command_handlers[fn->second.opcode])();
+    if (!rejection) command_latencies[fn->second.opcode]->record(Metrics::now() - start);
   }
 }
 
+// execute a command that started with the words, and journal it if accepted
+void Controller::run_journaled(const string& start, std::function<void()> execute)
+{
+  int tick = Model::get_Instance().get_time();
+  Command_reader* source = reader;
+  Recording_reader recorder(*source, start);
+  reader = &recorder;
+  try {
+    execute();
+  } catch (...) {
+    reader = source;
+    throw;
+  }
+  reader = source;
+  if (!rejection) journal->append(tick, recorder.get_text());
+}
+
 // handle status command for model
 void Controller::status()
 {
   Model::get_Instance().describe();
 }
 
-// handle go command for model
+// the most ticks a go until runs waiting for its event
+static const int MAX_UNTIL_TICKS = 1000;
+
+// the names of the events a trigger can wait for
+static const struct {
+  const char* name;
+  Ship::Event event;
+} event_names[] = {
+  {"arrives", Ship::ARRIVES}, {"docks", Ship::DOCKS}, {"runs_dry", Ship::RUNS_DRY},
+  {"sinks", Ship::SINKS}, {"loaded", Ship::LOADED}
+};
+
+// handle go command for model: one tick, or with until, the ticks until a
+// ship's event, the ship is gone, or MAX_UNTIL_TICKS have passed
 void Controller::go()
 {
-  Model::get_Instance().update();
+  Model& model = Model::get_Instance();
+  if (!reader->read_keyword("until")) {
+    model.update();
+    return;
+  }
+  string ship_name;
+  unsigned event;
+  if (!get_event(ship_name, event)) return;
+  bool happened = false;
+  int trigger = model.add_trigger(ship_name, event, [&happened] {happened = true;});
+  int ticks = 0;
+  while (!happened && ticks < MAX_UNTIL_TICKS && model.is_ship_present(ship_name)) {
+    model.update();
+    ++ticks;
+  }
+  if (!happened) {
+    model.remove_trigger(trigger);
+    cout << "Stopped after " << ticks << " ticks without the event" << endl;
+  }
+}
+
+// handle when command for model: run the rest of the line as commands when
+// the ship next has the event
+void Controller::when()
+{
+  string ship_name;
+  unsigned event;
+  if (!get_event(ship_name, event)) return;
+  if (!reader->read_keyword("do")) return reject("Expected do!");
+  string text;
+  reader->read_line(text);
+  if (text.empty()) return reject("Expected a command!");
+  if (!is_trigger_command(text)) return reject("Cannot run that command from a trigger!");
+  Model::get_Instance().add_trigger(ship_name, event, [this, text] {run_trigger_command(text);});
 }
 
 // handle create command for model
 void Controller::create()
 {
   string ship_name;
-  cin >> ship_name;
+  reader->read_word(ship_name);
   if (ship_name.size() < 2) { // NOTE: MAGIC NUMBER
-    throw Error("Name is too short!");
+    return reject("Name is too short!");
   }
   if (Model::get_Instance().is_name_in_use(ship_name)) {
-    throw Error("Name is already in use!");
+    return reject("Name is already in use!");
   }
   string type;
-  cin >> type;
-  Point point = get_Point();
+  reader->read_word(type);
+  Point point;
+  if (!get_Point(point)) return;
   Model::get_Instance().add_ship(create_ship(ship_name, type, point));
 }
 
+// handle create_fleet command for model: ships named the prefix's first character,
+// a second character that no other name starts with after it, then the rest of the
+// prefix, laid out on a square grid with spread between neighbors
+void Controller::create_fleet()
+{
+  // the second characters a fleet's names are given, in increasing order
+  static const string second_characters =
+    "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz";
+  string prefix;
+  reader->read_word(prefix);
+  if (prefix.size() < 2) {
+    return reject("Name is too short!");
+  }
+  string type;
+  reader->read_word(type);
+  int count;
+  if (!reader->read_int(count)) return reject("Expected an integer!");
+  if (count <= 0) {
+    return reject("Fleet size must be positive!");
+  }
+  Point origin;
+  if (!get_Point(origin)) return;
+  double spread;
+  if (!reader->read_double(spread)) return reject("Expected a double!");
+  if (spread < 0.0) {
+    return reject("Negative spread entered!");
+  }
+  // names must differ in their first two characters, so each ship takes a free one
+  Model& model = Model::get_Instance();
+  vector<string> names;
+  names.reserve(count);
+  for (char second : second_characters) {
+    if (int(names.size()) == count) break;
+    string name = prefix.substr(0, 1) + second + prefix.substr(1);
+    if (!model.is_name_in_use(name)) names.push_back(name);
+  }
+  if (int(names.size()) < count) {
+    return reject("Not enough free names for the fleet!");
+  }
+  int side = int(std::ceil(std::sqrt(double(count))));
+  vector<shared_ptr<Ship>> fleet;
+  fleet.reserve(count);
+  for (int i = 0; i < count; ++i) {
+    Point position(origin.x + (i % side) * spread, origin.y + (i / side) * spread);
+    fleet.push_back(create_ship(names[i], type, position));
+  }
+  model.add_ships(fleet);
+}
+
 // handle show command for model
 void Controller::show()
 {
-  std::for_each(views.begin(), views.end(), std::mem_fn(&View::draw));
+  // the time to draw each view, by its type
+  for (auto& view : views) {
+    long long start = Metrics::now();
+    view->draw();
+    Metrics::get_Instance().get_histogram("draw " + type_name_of(typeid(*view)))->record(Metrics::now() - start);
+  }
+}
+
+// handle stats command for model
+void Controller::stats()
+{
+  Model::get_Instance().measure();
+  Metrics::get_Instance().print(cout);
+}
+
+// handle stats_dump command for model
+void Controller::stats_dump()
+{
+  string filename;
+  reader->read_word(filename);
+  int interval;
+  if (!reader->read_int(interval)) return reject("Expected an integer!");
+  if (interval <= 0) {
+    return reject("Dump interval must be positive!");
+  }
+  Metrics::get_Instance().start_dump(filename, interval);
+}
+
+// handle stats_dump_stop command for model
+void Controller::stats_dump_stop()
+{
+  if (!Metrics::get_Instance().is_dumping()) return reject("Stats are not being dumped!");
+  Metrics::get_Instance().stop_dump();
+}
+
+// handle logistics command for model: the interval, then the tankers, the supply
+// islands and the demand islands, each as a count followed by the names
+void Controller::start_logistics()
+{
+  int interval;
+  if (!reader->read_int(interval)) return reject("Expected an integer!");
+  if (interval <= 0) {
+    return reject("Logistics interval must be positive!");
+  }
+  vector<shared_ptr<Tanker>> tankers;
+  int count;
+  if (!get_count(count)) return;
+  for (int i = 0; i < count; ++i) {
+    string name;
+    reader->read_word(name);
+    shared_ptr<Ship> ship = Model::get_Instance().find_ship(name);
+    if (!ship) return reject("Ship not found!");
+    shared_ptr<Tanker> tanker = std::dynamic_pointer_cast<Tanker>(ship);
+    if (!tanker) return reject("Ship is not a tanker!");
+    tankers.push_back(tanker);
+  }
+  vector<shared_ptr<Island>> supplies, demands;
+  for (auto islands : {&supplies, &demands}) {
+    if (!get_count(count)) return;
+    for (int i = 0; i < count; ++i) {
+      shared_ptr<Island> island = get_island();
+      if (!island) return;
+      islands->push_back(island);
+    }
+  }
+  if (logistics) Model::get_Instance().remove_tick_task(logistics_task);
+  logistics.reset(new Logistics(tankers, supplies, demands));
+  logistics->assign();
+  logistics_task = Model::get_Instance().add_tick_task(interval, [this] {logistics->assign();});
+}
+
+// handle logistics_stop command for model; the tankers keep their last assignments
+void Controller::stop_logistics()
+{
+  if (!logistics) return reject("Logistics is not running!");
+  Model::get_Instance().remove_tick_task(logistics_task);
+  logistics.reset();
+}
+
+// handle fuel_policy command for model: fifo or fair_share
+void Controller::fuel_policy()
+{
+  shared_ptr<Island> island = get_island();
+  if (!island) return;
+  string policy;
+  reader->read_word(policy);
+  if (policy == "fifo")
+    island->set_fuel_policy(Island::Fuel_policy::FIFO);
+  else if (policy == "fair_share")
+    island->set_fuel_policy(Island::Fuel_policy::FAIR_SHARE);
+  else
+    return reject("Unrecognized fuel policy!");
+}
+
+// handle berths command for model: the ships docked at the island, in name order
+void Controller::berths()
+{
+  shared_ptr<Island> island = get_island();
+  if (!island) return;
+  vector<string> names;
+  for (Ship* ship : island->get_docked_ships()) {
+    names.push_back(ship->get_name());
+  }
+  std::sort(names.begin(), names.end());
+  cout << "Docked at " << island->get_name() << ":";
+  for (auto& name : names) {
+    cout << " " << name;
+  }
+  cout << endl;
 }
 
 // handle open_map_view command for model
 void Controller::open_map_view()
 {
-  if (map_view) throw Error("Map view is already open!");
+  if (map_view) return reject("Map view is already open!");
   map_view.reset(new MapView());
   add_view(map_view);
+  layout_live_views();
 }
 
 // handle close_map_view command for model
 void Controller::close_map_view()
 {
-  if (!map_view) throw Error("Map view is not open!");
+  if (!map_view) return reject("Map view is not open!");
   remove_view(map_view);
   map_view = nullptr;
+  layout_live_views();
 }
 
 // handle open_sailing_view command for model
 void Controller::open_sailing_view()
 {
-  if (sailing_view) throw Error("Sailing data view is already open!");
+  if (sailing_view) return reject("Sailing data view is already open!");
   sailing_view.reset(new SailingDataView());
   add_view(sailing_view);
 }
@@ -150,7 +668,7 @@ void Controller::open_sailing_view()
 // handle close_sailing_view command for model
 void Controller::close_sailing_view()
 {
-  if (!sailing_view) throw Error("Sailing data view is not open!");
+  if (!sailing_view) return reject("Sailing data view is not open!");
   remove_view(sailing_view);
   sailing_view = nullptr;
 }
@@ -159,34 +677,116 @@ void Controller::close_sailing_view()
 void Controller::open_bridge_view()
 {
   string ownship;
-  cin >> ownship;
-  shared_ptr<Ship> ship = Model::get_Instance().get_ship_ptr(ownship);
+  reader->read_word(ownship);
+  if (!Model::get_Instance().is_ship_present(ownship)) return reject("Ship not found!");
   if (bridge_views.find(ownship) != bridge_views.end())
-    throw Error("Bridge view is already open for that ship!");
+    return reject("Bridge view is already open for that ship!");
   shared_ptr<BridgeView> new_view(new BridgeView(ownship));
   bridge_views.insert(std::pair<string, shared_ptr<BridgeView>>(ownship, new_view));
   add_view(new_view);
+  layout_live_views();
 }
 
 // handle close_bridge_view command for model
 void Controller::close_bridge_view()
 {
   string ownship;
-  cin >> ownship;
+  reader->read_word(ownship);
   auto target = bridge_views.find(ownship);
   if (target == bridge_views.end())
-    throw Error("Bridge view for that ship is not open!");
+    return reject("Bridge view for that ship is not open!");
   remove_view(target->second);
   bridge_views.erase(ownship);
+  layout_live_views();
+}
+
+// handle display command for view: live or normal
+void Controller::display()
+{
+  string mode;
+  reader->read_word(mode);
+  if (mode == "live") {
+    live_display = true;
+    layout_live_views();
+  } else if (mode == "normal") {
+    if (!live_display) return;
+    live_display = false;
+    if (map_view) map_view->set_normal();
+    for (auto& bridge : bridge_views) {
+      bridge.second->set_normal();
+    }
+    cout << "\033[r\033[2J\033[H"; // whole screen scrolls again
+  } else {
+    return reject("Unrecognized display mode!");
+  }
+}
+
+// handle open_density_view command for model
+void Controller::open_density_view()
+{
+  if (density_view) return reject("Density view is already open!");
+  density_view.reset(new DensityView());
+  add_view(density_view);
+}
+
+// handle close_density_view command for model
+void Controller::close_density_view()
+{
+  if (!density_view) return reject("Density view is not open!");
+  remove_view(density_view);
+  density_view = nullptr;
+}
+
+// handle open_telemetry_view command for model
+void Controller::open_telemetry_view()
+{
+  if (telemetry_view) return reject("Telemetry view is already open!");
+  string filename, format;
+  reader->read_word(filename);
+  reader->read_word(format);
+  TelemetryView::Format telemetry_format;
+  if (format == "csv")
+    telemetry_format = TelemetryView::Format::CSV;
+  else if (format == "binary")
+    telemetry_format = TelemetryView::Format::BINARY;
+  else
+    return reject("Unrecognized telemetry format!");
+  telemetry_view.reset(new TelemetryView(filename, telemetry_format));
+  add_view(telemetry_view);
 }
 
-// quit from the controller run
+// handle close_telemetry_view command for model
+void Controller::close_telemetry_view()
+{
+  if (!telemetry_view) return reject("Telemetry view is not open!");
+  remove_view(telemetry_view);
+  telemetry_view = nullptr;
+}
+
+// quit from the controller run; the telemetry file is completed first
 void Controller::quit()
 {
+  if (telemetry_view) close_telemetry_view();
   cout << "Done" << endl;
 }
 
 // helpers
+void Controller::add_command(const string& name, void (Controller::*handler)(), const string& operands)
+{
+  Command_signature signature = {int(command_handlers.size()), operands};
+  commands[name] = signature;
+  command_handlers.push_back(handler);
+  command_latencies.push_back(Metrics::get_Instance().get_histogram("command " + name));
+}
+
+void Controller::add_ship_command(const string& name, void (Controller::*handler)(shared_ptr<Ship>), const string& operands)
+{
+  Command_signature signature = {int(ship_command_handlers.size()), operands};
+  ship_commands[name] = signature;
+  ship_command_handlers.push_back(handler);
+  ship_command_latencies.push_back(Metrics::get_Instance().get_histogram("command " + name));
+}
+
 void Controller::add_view(shared_ptr<View> view)
 {
   views.push_back(view);
@@ -199,90 +799,241 @@ void Controller::remove_view(shared_ptr<View> view)
   views.erase(find(views.begin(), views.end(), view));
 }
 
-// get input point from user
-Point Controller::get_Point()
+// in live display, stack the map and bridge views at the top of the terminal
+// and scroll the rest of the output below them
+void Controller::layout_live_views()
+{
+  if (!live_display) return;
+  int row = 1;
+  if (map_view) {
+    map_view->set_live(row);
+    row += map_view->get_live_height();
+  }
+  for (auto& bridge : bridge_views) {
+    bridge.second->set_live(row);
+    row += bridge.second->get_live_height();
+  }
+  // clear, confine scrolling below the frames, and continue there
+  cout << "\033[r\033[2J\033[" << row << ";r\033[" << row << ";1H";
+}
+
+// get input point from user; return false if rejected
+bool Controller::get_Point(Point& point)
 {
   double x, y;
-  cin >> x;
-  if (!cin) throw Error("Expected a double!"); // NOTE: CAN USE !(CIN>>X>>Y) DIRECTLY
-  cin >> y;
-  if (!cin) throw Error("Expected a double!");
-  return Point(x,y);
+  if (!reader->read_double(x) || !reader->read_double(y)) {
+    reject("Expected a double!");
+    return false;
+  }
+  point = Point(x,y);
+  return true;
 }
 
-// get input speed from user
-double Controller::get_speed()
+// get input speed from user; return false if rejected
+bool Controller::get_speed(double& speed)
 {
-  double speed;
-  cin >> speed;
-  if (!cin) throw Error("Expected a double!");
+  if (!reader->read_double(speed)) {
+    reject("Expected a double!");
+    return false;
+  }
   if (speed < 0.0) {
-    throw Error("Negative speed entered!");
+    reject("Negative speed entered!");
+    return false;
   }
-  return speed;
+  return true;
 }
 
-// get input island from user
+// get input island from user; return nullptr if rejected
 shared_ptr<Island> Controller::get_island() //NOTE: POSSIBILY MEANINGLESS FUNCTION
 {
+  shared_ptr<Island> island;
+  if (reader->read_island(island)) return island;
   string island_name;
-  cin >> island_name;
-  return Model::get_Instance().get_island_ptr(island_name);
+  reader->read_word(island_name);
+  island = Model::get_Instance().find_island(island_name);
+  if (!island) reject("Island not found!");
+  return island;
+}
+
+// get input count of names from user; return false if rejected
+bool Controller::get_count(int& count)
+{
+  if (!reader->read_int(count)) {
+    reject("Expected an integer!");
+    return false;
+  }
+  if (count <= 0) {
+    reject("Count must be positive!");
+    return false;
+  }
+  return true;
+}
+
+// get input ship name and event name from user; return false if rejected
+bool Controller::get_event(string& ship_name, unsigned& event)
+{
+  reader->read_word(ship_name);
+  if (!Model::get_Instance().is_ship_present(ship_name)) {
+    reject("Ship not found!");
+    return false;
+  }
+  string event_name;
+  reader->read_word(event_name);
+  for (auto& entry : event_names) {
+    if (event_name == entry.name) {
+      event = entry.event;
+      return true;
+    }
+  }
+  reject("Unrecognized event!");
+  return false;
+}
+
+// false if the text has a command that must not run from a trigger: one that
+// runs ticks from within a tick, or quits
+bool Controller::is_trigger_command(const string& text)
+{
+  std::istringstream words(text);
+  string word;
+  while (words >> word) {
+    if (word == "go" || word == "quit") return false;
+  }
+  return true;
+}
+
+// run the commands of a fired trigger; they are not journaled, as replaying
+// the when that added the trigger runs them again
+void Controller::run_trigger_command(const string& text)
+{
+  Command_reader* saved_reader = reader;
+  std::unique_ptr<Command_journal> saved_journal = std::move(journal);
+  Script_reader script_reader(text.data(), text.data() + text.size());
+  reader = &script_reader;
+  string word;
+  while (reader->read_word(word) && run_command(word));
+  reader = saved_reader;
+  journal = std::move(saved_journal);
+}
+
+// note the command as rejected with the message, to be reported without throwing
+void Controller::reject(const char* message)
+{
+  rejection = message;
+}
+
+// true if the ship has the capability, else the command is rejected with the message
+bool Controller::check_capability(shared_ptr<Ship> ship, unsigned capability, const char* message)
+{
+  if (ship->has_capability(capability)) return true;
+  reject(message);
+  return false;
 }
 
 // handle default command for view
 void Controller::view_default()
 {
-  if (!map_view) throw Error("Map view is not open!");
+  if (!map_view) return reject("Map view is not open!");
   map_view->set_defaults(); 
 }
  
 // handle size command for view
 void Controller::view_size()
 {
-  if (!map_view) throw Error("Map view is not open!");
+  if (!map_view) return reject("Map view is not open!");
   int size;
-  cin >> size;
-  if (!cin) throw Error("Expected an integer!");
+  if (!reader->read_int(size)) return reject("Expected an integer!");
   map_view->set_size(size);
 }
 
 // handle zoom command for view
 void Controller::view_zoom()
 {
-  if (!map_view) throw Error("Map view is not open!");
+  if (!map_view) return reject("Map view is not open!");
   double scale;
-  cin >> scale;
-  if (!cin) throw Error("Expected a double!");
+  if (!reader->read_double(scale)) return reject("Expected a double!");
   map_view->set_scale(scale);
 }
 
 // handle pan command for view
 void Controller::view_pan()
 {
-  if (!map_view) throw Error("Map view is not open!");
-  Point point = get_Point();
+  if (!map_view) return reject("Map view is not open!");
+  Point point;
+  if (!get_Point(point)) return;
   map_view->set_origin(point);
 }
 
+// handle density_default command for view
+void Controller::density_default()
+{
+  if (!density_view) return reject("Density view is not open!");
+  density_view->set_defaults();
+}
+
+// handle density_size command for view
+void Controller::density_size()
+{
+  if (!density_view) return reject("Density view is not open!");
+  int size;
+  if (!reader->read_int(size)) return reject("Expected an integer!");
+  density_view->set_size(size);
+}
+
+// handle density_zoom command for view
+void Controller::density_zoom()
+{
+  if (!density_view) return reject("Density view is not open!");
+  double scale;
+  if (!reader->read_double(scale)) return reject("Expected a double!");
+  density_view->set_scale(scale);
+}
+
+// handle density_pan command for view
+void Controller::density_pan()
+{
+  if (!density_view) return reject("Density view is not open!");
+  Point point;
+  if (!get_Point(point)) return;
+  density_view->set_origin(point);
+}
+
+// handle density_style command for view
+void Controller::density_style()
+{
+  if (!density_view) return reject("Density view is not open!");
+  string style;
+  reader->read_word(style);
+  density_view->set_style(style);
+}
+
+// handle density_filter command for view
+void Controller::density_filter()
+{
+  if (!density_view) return reject("Density view is not open!");
+  string filter;
+  reader->read_word(filter);
+  density_view->set_filter(filter);
+}
+
 // handle course command for ship
 void Controller::ship_course(shared_ptr<Ship> ship)
 {
   double heading;
-  cin >> heading;
-  if (!cin) throw Error("Expected a double!");
+  if (!reader->read_double(heading)) return reject("Expected a double!");
   if (heading < 0.0 || heading >= 360.0) {
-    throw Error("Invalid heading entered!");
+    return reject("Invalid heading entered!");
   }
-  double speed = get_speed();
+  double speed;
+  if (!get_speed(speed)) return;
   ship->set_course_and_speed(heading, speed);
 }
 
 // handle position command for ship
 void Controller::ship_position(shared_ptr<Ship> ship)
 {
-  Point point = get_Point();
-  double speed = get_speed();
+  Point point;
+  double speed;
+  if (!get_Point(point) || !get_speed(speed)) return;
   ship->set_destination_position_and_speed(point, speed);
 }
 
@@ -290,34 +1041,44 @@ void Controller::ship_position(shared_ptr<Ship> ship)
 void Controller::ship_destination(shared_ptr<Ship> ship)
 {
   shared_ptr<Island> island = get_island();
-  double speed = get_speed();
+  double speed;
+  if (!island || !get_speed(speed)) return;
   ship->set_destination_position_and_speed(island->get_location(), speed);
 }
 
 // handle load_at command for ship
 void Controller::ship_load_at(shared_ptr<Ship> ship)
 {
-  ship->set_load_destination(get_island());
+  shared_ptr<Island> island = get_island();
+  if (!island || !check_capability(ship, Ship::CAN_LOAD, "Cannot load at a destination!")) return;
+  ship->set_load_destination(island);
 }
 
 // handle unload_at command for ship
 void Controller::ship_unload_at(shared_ptr<Ship> ship)
 {
-  ship->set_unload_destination(get_island());
+  shared_ptr<Island> island = get_island();
+  if (!island || !check_capability(ship, Ship::CAN_UNLOAD, "Cannot unload at a destination!")) return;
+  ship->set_unload_destination(island);
 }
 
 // handle dock_at command for ship
 void Controller::ship_dock_at(shared_ptr<Ship> ship)
 {
-  ship->dock(get_island());
+  shared_ptr<Island> island = get_island();
+  if (!island) return;
+  ship->dock(island);
 }
 
 // handle attack command for ship
 void Controller::ship_attack(shared_ptr<Ship> ship)
 {
   string target_name;
-  cin >> target_name;
-  ship->attack(Model::get_Instance().get_ship_ptr(target_name));
+  reader->read_word(target_name);
+  shared_ptr<Ship> target = Model::get_Instance().find_ship(target_name);
+  if (!target) return reject("Ship not found!");
+  if (!check_capability(ship, Ship::CAN_ATTACK, "Cannot attack!")) return;
+  ship->attack(*target);
 }
 
 // handle refuel command for ship
@@ -335,6 +1096,32 @@ void Controller::ship_stop(shared_ptr<Ship> ship)
 // handle stop_attack command for ship
 void Controller::ship_stop_attack(shared_ptr<Ship> ship)
 {
+  if (!check_capability(ship, Ship::CAN_ATTACK, "Cannot attack!")) return;
   ship->stop_attack();
 }
 
+// handle patrol command for ship: center, radius and speed
+void Controller::ship_patrol(shared_ptr<Ship> ship)
+{
+  Point center;
+  double radius, speed;
+  if (!get_Point(center)) return;
+  if (!reader->read_double(radius)) return reject("Expected a double!");
+  if (radius <= 0.) return reject("Patrol radius must be positive!");
+  if (!get_speed(speed) || !check_capability(ship, Ship::CAN_ATTACK, "Cannot attack!")) return;
+  ship->patrol(center, radius, speed);
+}
+
+// handle itinerary command for ship: greedy or optimized
+void Controller::ship_itinerary(shared_ptr<Ship> ship)
+{
+  if (!check_capability(ship, Ship::CAN_CRUISE, "Cannot cruise!")) return;
+  string order;
+  reader->read_word(order);
+  if (order == "greedy")
+    ship->set_itinerary(Ship::Itinerary::GREEDY);
+  else if (order == "optimized")
+    ship->set_itinerary(Ship::Itinerary::OPTIMIZED);
+  else
+    return reject("Unrecognized itinerary!");
+}
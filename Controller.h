@@ -8,49 +8,151 @@ with the user.
 #include <memory>
 #include <map>
 #include <vector>
+#include <string>
+#include <functional>
+#include "Command_program.h"
+#include "Metrics.h"
 
 //class Model; //pending
 class View;
 class MapView;
 class SailingDataView;
 class BridgeView;
+class DensityView;
+class TelemetryView;
 class Ship;
 class Island;
 class Point;
+class Command_reader;
+class Script_reader;
+class Command_server;
+class Command_journal;
+class Logistics;
 
 class Controller {
 public:  
+  // set up the command tables
+  Controller();
+  // the journal is completed when destroyed
+  ~Controller();
   // create View object, run the program by acccepting user commands, then destroy View object
   void run();
+  // run the commands in the script file without prompting
+  void run_script(const std::string& filename);
+  // run the script compiled to a Command_program, interpreting the lines that did not compile
+  void run_compiled(const std::string& filename);
+  // serve the clients of a Command_server listening at the socket path until stopped by a signal
+  void run_server(const std::string& path);
+  // replay the journal with the output muted before the tick, then accept user commands
+  void run_replay(const std::string& filename, int unmute_tick);
+  // start journaling the accepted commands to the file; return false if it cannot be created
+  bool open_journal(const std::string& filename);
 
 private:
   std::shared_ptr<MapView> map_view; //ptr to the only map view
   std::shared_ptr<SailingDataView> sailing_view; //ptr to the only sailing view
+  std::shared_ptr<DensityView> density_view; //ptr to the only density view
+  std::shared_ptr<TelemetryView> telemetry_view; //ptr to the only telemetry view
   // map of ownship_name, bridge_view_ptr of the ownship
   std::map<std::string, std::shared_ptr<BridgeView>> bridge_views;
   // list of views in constructing order 
   std::vector<std::shared_ptr<View>> views;
+  // true if map and bridge views draw as fixed frames updated in place
+  bool live_display = false;
+  // the source of the command being executed
+  Command_reader* reader;
+  // the message of the command being executed if it has been rejected, else nullptr;
+  // handlers reject what they can check up front instead of throwing, which is much
+  // cheaper when a script is full of rejected commands
+  const char* rejection;
+  // where the accepted commands are journaled, if anywhere
+  std::unique_ptr<Command_journal> journal;
+  // the tanker schedule, if running, and the Model's tick task that runs it
+  std::unique_ptr<Logistics> logistics;
+  int logistics_task;
+  // command name to signature, for general commands and for ship commands
+  Command_signatures commands;
+  Command_signatures ship_commands;
+  // the jump tables of handlers, indexed by the signatures' opcodes
+  std::vector<void (Controller::*)()> command_handlers;
+  std::vector<void (Controller::*)(std::shared_ptr<Ship>)> ship_command_handlers;
+  // the latency of each handler, indexed the same way
+  std::vector<Metrics::Histogram*> command_latencies;
+  std::vector<Metrics::Histogram*> ship_command_latencies;
 
   //helper
   // add & remove view from controller and model's list
   void add_view(std::shared_ptr<View> view);
   void remove_view(std::shared_ptr<View> view);
-  // get input point from user
-  Point get_Point();
-  // get input speed from user
-  double get_speed();
-  // get input island from user
+  // get input point from user; return false if rejected
+  bool get_Point(Point& point);
+  // get input speed from user; return false if rejected
+  bool get_speed(double& speed);
+  // get input island from user; return nullptr if rejected
   std::shared_ptr<Island> get_island();
+  // get input count of names from user; return false if rejected
+  bool get_count(int& count);
+  // get input ship name and event name from user; return false if rejected
+  bool get_event(std::string& ship_name, unsigned& event);
+  // false if the text has a command that must not run from a trigger
+  static bool is_trigger_command(const std::string& text);
+  // run the commands of a fired trigger
+  void run_trigger_command(const std::string& text);
+  // note the command as rejected with the message, to be reported without throwing
+  void reject(const char* message);
+  // true if the ship has the capability, else the command is rejected with the message
+  bool check_capability(std::shared_ptr<Ship> ship, unsigned capability, const char* message);
+  // in live display, stack the map and bridge views at the top of the terminal
+  // and scroll the rest of the output below them
+  void layout_live_views();
+  // read and execute commands from reader_ until quit or the end of the input
+  void run_commands(Command_reader& reader_, bool prompt);
+  // execute the program; script_reader reads its text where it must be interpreted
+  // return false if the commands end with quit
+  bool run_program(Command_program& program, Script_reader& script_reader);
+  // compile and run the commands in [begin, end); return false if the commands end with quit
+  bool replay_commands(const char* begin, const char* end);
+  // run a client's lines with its output sent back to it; a command must be on one line
+  // return false if the program must end
+  bool run_client_commands(Command_server& server, int id, const std::string& lines);
+  // execute the command that starts with word; return false if the commands end here
+  bool run_command(const std::string& word);
+  // execute the command that starts with word; a rejected command leaves rejection set
+  void dispatch_command(const std::string& word);
+  // execute a command that started with the words, and journal it if accepted
+  void run_journaled(const std::string& start, std::function<void()> execute);
+  // add a command and its handler to the tables
+  void add_command(const std::string& name, void (Controller::*handler)(), const std::string& operands);
+  void add_ship_command(const std::string& name, void (Controller::*handler)(std::shared_ptr<Ship>),
+    const std::string& operands);
 
   // command handler
   // handle status command for model
   void status();
   // handle go command for model
   void go();
+  // handle when command for model
+  void when();
   // handle create command for model
   void create();
+  // handle create_fleet command for model
+  void create_fleet();
   // handle show command for model
   void show();
+  // handle stats command for model
+  void stats();
+  // handle stats_dump command for model
+  void stats_dump();
+  // handle stats_dump_stop command for model
+  void stats_dump_stop();
+  // handle logistics command for model
+  void start_logistics();
+  // handle logistics_stop command for model
+  void stop_logistics();
+  // handle fuel_policy command for model
+  void fuel_policy();
+  // handle berths command for model
+  void berths();
   // handle open_map_view command for model
   void open_map_view();
   // handle close_map_view command for model
@@ -63,6 +165,16 @@ private:
   void open_bridge_view();
   // handle close_bridge_view command for model
   void close_bridge_view();
+  // handle display command for view: live or normal
+  void display();
+  // handle open_density_view command for model
+  void open_density_view();
+  // handle close_density_view command for model
+  void close_density_view();
+  // handle open_telemetry_view command for model
+  void open_telemetry_view();
+  // handle close_telemetry_view command for model
+  void close_telemetry_view();
   // quit from the controller run
   void quit();
   // handle default command for view
@@ -73,6 +185,18 @@ private:
   void view_zoom();
   // handle pan command for view
   void view_pan();
+  // handle density_default command for view
+  void density_default();
+  // handle density_size command for view
+  void density_size();
+  // handle density_zoom command for view
+  void density_zoom();
+  // handle density_pan command for view
+  void density_pan();
+  // handle density_style command for view
+  void density_style();
+  // handle density_filter command for view
+  void density_filter();
   // handle course command for ship
   void ship_course(std::shared_ptr<Ship> ship);
   // handle position command for ship
@@ -93,5 +217,9 @@ private:
   void ship_stop(std::shared_ptr<Ship> ship);
   // handle stop_attack command for ship
   void ship_stop_attack(std::shared_ptr<Ship> ship);
+  // handle itinerary command for ship
+  void ship_itinerary(std::shared_ptr<Ship> ship);
+  // handle patrol command for ship
+  void ship_patrol(std::shared_ptr<Ship> ship);
 };
 #endif
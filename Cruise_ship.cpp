@@ -1,6 +1,7 @@
 #include "Cruise_ship.h"
 #include "Model.h"
 #include "Island.h"
+#include "Island_registry.h"
 #include <string>
 #include <iostream>
 using std::cout;
@@ -8,17 +9,12 @@ using std::endl;
 using std::string;
 using std::shared_ptr;
 
-const double Cruise_ship::FUEL_CAPACITY = 500.0;
-const double Cruise_ship::MAX_SPEED = 15.0;
-const double Cruise_ship::FUEL_CONSUMPTION = 2.0;
-const int Cruise_ship::RESISTANCE = 0;
-
-Cruise_ship::Cruise_ship(const std::string& name_, Point position_)
-  :Ship(name_, position_, FUEL_CAPACITY, MAX_SPEED, FUEL_CONSUMPTION, RESISTANCE), 
-    cruise_destination(nullptr), cruise_state(State::NOT_CRUISING)
-{
-  all_islands =  Model::get_Instance().get_islands(); //NOTE: CONSITER STORE UNVISITED ISLAND LIST: LOWER COMPLEXITY
-}
+Cruise_ship::Cruise_ship(const std::string& name_, Point position_, int type_id_)
+  :Ship(name_, position_, type_id_, CAN_CRUISE), 
+    cruise_destination(Island_registry::NO_ISLAND), next_stop(Island_registry::NO_ISLAND),
+    cruise_speed(0), cruise_state(State::NOT_CRUISING), visited_count(0),
+    itinerary(Itinerary::GREEDY), tour_stop(0)
+{}
 
 // return true if status != not_cruising
 bool Cruise_ship::is_cruising() const
@@ -32,13 +28,17 @@ void Cruise_ship::set_destination_position_and_speed(Point destination_position,
 {
   cancel_cruise();
   Ship::set_destination_position_and_speed(destination_position, speed);
-  cruise_destination = get_island(destination_position);
+  cruise_destination = Model::get_Instance().get_island_registry().find(destination_position);
   // can start a cruise
-  if (cruise_destination) {
+  if (cruise_destination != Island_registry::NO_ISLAND) {
     next_stop = cruise_destination;
     cruise_speed = speed;
-    cout << get_name() << " will visit " << next_stop->get_name() << endl;
-    cout << get_name() << " cruise will start and end at " << cruise_destination->get_name() << endl;
+    if (itinerary == Itinerary::OPTIMIZED) {
+      tour = Model::get_Instance().get_island_registry().get_tour(cruise_destination);
+      tour_stop = 0;
+    }
+    cout << get_name() << " will visit " << get_island(next_stop)->get_name() << endl;
+    cout << get_name() << " cruise will start and end at " << get_island(cruise_destination)->get_name() << endl;
     cruise_state = State::TO_NEXT_STOP;
   }
 }
@@ -57,6 +57,14 @@ void Cruise_ship::stop()
   Ship::stop();
 }
 
+// choose the order of the cruises started from now on
+void Cruise_ship::set_itinerary(Itinerary itinerary_)
+{
+  itinerary = itinerary_;
+  cout << get_name() << " will cruise in " << (itinerary == Itinerary::GREEDY ? "greedy" : "optimized")
+    << " order" << endl;
+}
+
 // update cruise state according to current state
 void Cruise_ship::update()
 {
@@ -66,14 +74,19 @@ void Cruise_ship::update()
   } else {
     switch (cruise_state) {
       case State::TO_NEXT_STOP:
-        if (!is_moving() && can_dock(next_stop)) {
-          dock(next_stop);
-          if (next_stop == cruise_destination && !visited_islands.empty()){
-            cout << get_name() << " cruise is over at " << cruise_destination->get_name() << endl;
+        if (!is_moving() && can_dock(get_island(next_stop))) {
+          dock(get_island(next_stop));
+          if (next_stop == cruise_destination && visited_count){
+            cout << get_name() << " cruise is over at " << get_island(cruise_destination)->get_name() << endl;
             cruise_end();
           } else {
             cruise_state = State::REFUEL;
-            visited_islands.insert(std::pair<string, shared_ptr<Island>>(next_stop->get_name(), next_stop));
+            if (visited_islands.empty())
+              visited_islands.resize(Model::get_Instance().get_island_registry().size());
+            if (!visited_islands[next_stop]) {
+              visited_islands[next_stop] = true;
+              ++visited_count;
+            }
           }
         }
         break;
@@ -90,13 +103,17 @@ void Cruise_ship::update()
       }
       case State::SET_COURSE:
       {
-        next_stop = get_next_stop();
-        if (!next_stop) { // return to beginning
+        if (tour) {
+          next_stop = ++tour_stop < int(tour->size()) ? (*tour)[tour_stop] : Island_registry::NO_ISLAND;
+        } else {
+          next_stop = get_next_stop();
+        }
+        if (next_stop == Island_registry::NO_ISLAND) { // return to beginning
           next_stop = cruise_destination;
         }
-        Ship::set_destination_position_and_speed(next_stop->get_location(), cruise_speed);
+        Ship::set_destination_position_and_speed(get_island(next_stop)->get_location(), cruise_speed);
         cruise_state = State::TO_NEXT_STOP;
-        cout << get_name() << " will visit " << next_stop->get_name() << endl;
+        cout << get_name() << " will visit " << get_island(next_stop)->get_name() << endl;
         break;
       }
       default:
@@ -108,44 +125,33 @@ void Cruise_ship::update()
 // output information about the current state
 void Cruise_ship::describe() const
 {
-  cout << "\nCruise_ship ";
+  cout << "\n" << get_type_name() << " ";
   Ship::describe();
   if (is_cruising()) {
     if (cruise_state == State::TO_NEXT_STOP){
-        cout << "On cruise to " << next_stop->get_name() << endl;
+        cout << "On cruise to " << get_island(next_stop)->get_name() << endl;
     } else {
-        cout << "Waiting during cruise at " << next_stop->get_name() << endl;
+        cout << "Waiting during cruise at " << get_island(next_stop)->get_name() << endl;
     }
   }
 }
 
-// will return nullptr if no island is at the point
-shared_ptr<Island> Cruise_ship::get_island(Point point) const
-{
-  for (auto it : all_islands) {
-    if (it->get_location() == point) {
-      return it;
-    }
-  }
-  return nullptr;
-}
-
-// will return nullptr if no island is not visited
-shared_ptr<Island> Cruise_ship::get_next_stop() const
+// will return NO_ISLAND if every island is visited; ties go to the first in name order
+int Cruise_ship::get_next_stop() const
 {
+  const Island_registry& islands = Model::get_Instance().get_island_registry();
   Point point = get_docked_Island()->get_location();
   double shortest = -1;
-  shared_ptr<Island> next_stop;
-  for (auto it : all_islands) {
-    if (visited_islands.find(it->get_name()) == visited_islands.end()) {
-      double distance = cartesian_distance(it->get_location(), point);
-      if (distance < shortest || shortest < 0) {
-         shortest = distance;
-         next_stop = it;
-       } 
-     } 
-   } 
-   return next_stop;
+  int next = Island_registry::NO_ISLAND;
+  for (int i = 0; i < islands.size(); ++i) {
+    if (visited_islands[i]) continue;
+    double distance = cartesian_distance(islands[i]->get_location(), point);
+    if (distance < shortest || shortest < 0) {
+      shortest = distance;
+      next = i;
+    }
+  }
+  return next;
 }
 
 // cancel a cruise if in a cruise, print end msg
@@ -160,9 +166,11 @@ void Cruise_ship::cancel_cruise()
 // cancel a cruise, reset all the values
 void Cruise_ship::cruise_end()
 {
-  cruise_destination = nullptr;
-  next_stop = nullptr;
+  cruise_destination = Island_registry::NO_ISLAND;
+  next_stop = Island_registry::NO_ISLAND;
   cruise_speed = 0;
   visited_islands.clear();
+  visited_count = 0;
+  tour.reset();
   cruise_state = State::NOT_CRUISING;
 }
@@ -1,13 +1,12 @@
 #ifndef CRUISE_SHIP
 #define CRUISE_SHIP
 #include "Ship.h"
-#include <map>
 #include <vector>
 #include <memory>
 
 class Cruise_ship : public Ship {
 public:
-  Cruise_ship(const std::string& name_, Point position_);
+  Cruise_ship(const std::string& name_, Point position_, int type_id_);
   // return true if status != not_cruising
   bool is_cruising() const; //NOTE: CAN BE PRIVATE: YAGNI?
 
@@ -18,6 +17,10 @@ public:
   void set_course_and_speed(double course, double speed) override;
   // stops the cruise trip if is cruising
   void stop() override;
+  // choose the order of the cruises started from now on: GREEDY, the default,
+  // goes to the nearest unvisited island at each stop; OPTIMIZED follows the
+  // tour planned when the cruise starts
+  void set_itinerary(Itinerary itinerary_) override;
   // update cruise state according to current state
   void update() override;
   // output information about the current state
@@ -25,24 +28,20 @@ public:
 
 private:
   enum class State {NOT_CRUISING, TO_NEXT_STOP, REFUEL, WAIT, SET_COURSE};
-  // default values
-  static const double FUEL_CAPACITY; // NOTE: NO CAPITAL
-  static const double MAX_SPEED;
-  static const double FUEL_CONSUMPTION;
-  static const int RESISTANCE;
-
-  std::shared_ptr<Island> cruise_destination; // the desitination of a cruise trip
-  std::shared_ptr<Island> next_stop; // the next stop of the cruise
+  // islands by their index in the Model's Island_registry, NO_ISLAND if none
+  int cruise_destination; // the desitination of a cruise trip
+  int next_stop; // the next stop of the cruise
   double cruise_speed; // the speed of the cruise
   State cruise_state; // the cruise state of the ship
-  std::map<std::string, std::shared_ptr<Island>> visited_islands; // the list of visted islands
-  std::vector<std::shared_ptr<Island>> all_islands; //the list of all islands
+  std::vector<bool> visited_islands; // by island index, empty until the first visit
+  int visited_count; // the number of visited islands
+  Itinerary itinerary;
+  std::shared_ptr<const std::vector<int>> tour; // the planned tour of an OPTIMIZED cruise
+  int tour_stop; // the index in the tour of next_stop
 
   // helper
-  // get the island ptr by a position, return null if no island matches
-  std::shared_ptr<Island> get_island(Point point) const; 
-  // get the next cruise island, return to original dest if all islands are visited
-  std::shared_ptr<Island> get_next_stop() const;
+  // get the next cruise island, NO_ISLAND if all islands are visited
+  int get_next_stop() const;
   // cancel a cruise if in a cruise, print end msg
   void cancel_cruise();
   // cancel a cruise, reset all the values
@@ -3,17 +3,9 @@
 using std::cout;
 using std::endl;
 
-const double Cruiser::FUEL_CAPACITY = 1000.0;
-const double Cruiser::MAX_SPEED = 20.0;
-const double Cruiser::FUEL_CONSUMPTION = 10.0;
-const int Cruiser::RESISTANCE = 6;
-const int Cruiser::FIREPOWER = 3;
-const double Cruiser::MAX_ATTACKING_RANGE = 15.0;
-
 // initialize, then output constructor message
-Cruiser::Cruiser(const std::string& name_, Point position_)
-  :Warship(name_, position_, FUEL_CAPACITY, MAX_SPEED, FUEL_CONSUMPTION, 
-      RESISTANCE, FIREPOWER, MAX_ATTACKING_RANGE)
+Cruiser::Cruiser(const std::string& name_, Point position_, int type_id_)
+  :Warship(name_, position_, type_id_)
 {}
 
 // update the Cruiser: fire when in range; stop when target out of range
@@ -33,18 +25,18 @@ void Cruiser::update()
 // describe the Cruiser
 void Cruiser::describe() const
 {
-  cout << "\nCruiser ";
+  cout << "\n" << get_type_name() << " ";
   Warship::describe();
 }
 
 // Cruiser shall attack back when hit
-void Cruiser::receive_hit(int hit_force, std::shared_ptr<Ship> attacker_ptr)
+void Cruiser::receive_hit(int hit_force, Ship& attacker)
 {
-  Ship::receive_hit(hit_force, attacker_ptr);
+  Ship::receive_hit(hit_force, attacker);
   if (!is_afloat()) { // NOTE: CAN SIMPLIZE THIS TWO IF
     return;
   }
   if (!is_attacking()) {
-    attack(attacker_ptr);
+    attack(attacker);
   }
 }
@@ -1,16 +1,25 @@
 #include "Island.h"
 #include "Model.h"
 #include <iostream>
+#include <algorithm>
 using std::cout;
 using std::endl;
+using std::vector;
 
+const std::string Island::TYPE_NAME = "Island";
 const int Island::UNIT_TIME = 1;
 
 // initialize then output constructor message
 Island::Island (const std::string& name_, Point position_, double fuel_, double production_rate_)
-  :Sim_object(name_), position(position_), fuel(fuel_), production_rate(production_rate_)
+  :Sim_object(name_), position(position_), fuel(fuel_), production_rate(production_rate_),
+  fuel_policy(Fuel_policy::FIFO)
 {}
 
+const std::string& Island::get_type_name() const
+{
+  return TYPE_NAME;
+}
+
 // Return whichever is less, the request or the amount left,
 // update the amount on hand accordingly, and output the amount supplied.
 double Island::provide_fuel(double request)
@@ -33,6 +42,69 @@ void Island::accept_fuel(double amount)
   cout << "Island " << get_name() << " now has " << fuel << " tons" <<endl;
 }
 
+// change the policy; requests waiting under FAIR_SHARE are settled first
+void Island::set_fuel_policy(Fuel_policy policy)
+{
+  settle_fuel_requests();
+  fuel_policy = policy;
+}
+
+// the ship asks for the amount of fuel; deliver is called with the amount supplied
+void Island::request_fuel(double request, Ship_handle requester, std::function<void(double)> deliver)
+{
+  if (fuel_policy == Fuel_policy::FIFO) {
+    deliver(provide_fuel(request));
+    return;
+  }
+  Fuel_request fuel_request = {request, requester, std::move(deliver)};
+  fuel_requests.push_back(std::move(fuel_request));
+}
+
+// meet the waiting requests of the ships still present, in the order they were
+// made; the shares are worked out from the smallest request up
+void Island::settle_fuel_requests()
+{
+  if (fuel_requests.empty()) return;
+  // a ship that sank after asking gets no share, so its fuel stays here
+  vector<Fuel_request> requests;
+  requests.reserve(fuel_requests.size());
+  for (auto& request : fuel_requests) {
+    if (Model::get_Instance().get_ship(request.requester)) requests.push_back(std::move(request));
+  }
+  fuel_requests.clear();
+  vector<std::size_t> order(requests.size());
+  for (std::size_t i = 0; i < order.size(); ++i) order[i] = i;
+  std::stable_sort(order.begin(), order.end(),
+    [&requests](std::size_t a, std::size_t b) {return requests[a].amount < requests[b].amount;});
+  vector<double> shares(requests.size());
+  double left = fuel;
+  for (std::size_t i = 0; i < order.size(); ++i) {
+    double share = std::min(requests[order[i]].amount, left / (order.size() - i));
+    shares[order[i]] = share;
+    left -= share;
+  }
+  for (std::size_t i = 0; i < requests.size(); ++i) {
+    requests[i].deliver(provide_fuel(shares[i]));
+  }
+}
+
+// add the ship to the docked ships; return its berth
+int Island::add_berth(Ship* ship)
+{
+  berths.push_back(ship);
+  return int(berths.size()) - 1;
+}
+
+// remove the ship at the berth by moving the last ship into it
+Ship* Island::remove_berth(int berth)
+{
+  Ship* moved = berths.back();
+  berths.pop_back();
+  if (berth == int(berths.size())) return nullptr;
+  berths[berth] = moved;
+  return moved;
+}
+
 // if production_rate > 0, compute production_rate * unit time, and add to amount, and print
 // an update message
 void Island::update()
@@ -2,11 +2,28 @@
 /* Islands are a kind of Sim_object; they have an amount of fuel and a an amount by which it increases
 every update (default is zero). The can also provide or accept fuel, and update their amount
 accordingly.
+
+Ships ask for fuel with request_fuel, and the Island's fuel policy decides how the
+requests are met. Under FIFO, the default, each request is met at once, in the
+order made, so a ship early in the update order may take everything. Under
+FAIR_SHARE the requests of a tick wait until the Model settles them at the end of
+it, and the fuel is divided max-min fairly: every request gets an equal share,
+and what a small request does not use is shared among the larger ones. A request
+from a ship that is gone by then is dropped before the fuel is shared out. Either way
+the result depends only on the order the requests are made in.
+
+An Island also keeps the registry of the ships docked at it; a ship holds its
+berth's index, so docking and leaving take constant time.
 */
 #ifndef ISLAND_H 
 #define ISLAND_H
 #include "Sim_object.h"
 #include "Geometry.h"
+#include "Ship_handle.h"
+#include <vector>
+#include <functional>
+
+class Ship;
 
 class Island : public Sim_object
 {
@@ -19,7 +36,30 @@ public:
   double provide_fuel(double request);
   // Add the amount to the amount on hand, and output the total as the amount the Island now has.
   void accept_fuel(double amount);
+
+  enum class Fuel_policy {FIFO, FAIR_SHARE};
+  // change the policy; requests waiting under FAIR_SHARE are settled first
+  void set_fuel_policy(Fuel_policy policy);
+  // the ship asks for the amount of fuel; deliver is called with the amount supplied,
+  // at once or when the requests are settled, according to the fuel policy,
+  // and never if the ship is gone by then
+  void request_fuel(double request, Ship_handle requester, std::function<void(double)> deliver);
+  // meet the waiting requests of the ships still present, in the order they were made
+  void settle_fuel_requests();
+
+  // add the ship to the docked ships; return its berth
+  int add_berth(Ship* ship);
+  // remove the ship at the berth; return the ship moved into that berth, or nullptr if none
+  Ship* remove_berth(int berth);
+  // the ships docked here, in no particular order
+  const std::vector<Ship*>& get_docked_ships() const {return berths;}
+
+  // the amount on hand, and the amount added each update
+  double get_fuel() const {return fuel;}
+  double get_production_rate() const {return production_rate;}
   
+  const std::string& get_type_name() const override;
+
   Point get_location() const override
     {return position;}
 
@@ -42,7 +82,17 @@ private:
   Point position;        // Location of this island
   double fuel;    // amount of fuels initially for this island
   double production_rate;   // rate of fuel production for this island
+  Fuel_policy fuel_policy;
+  // the requests waiting to be settled
+  struct Fuel_request {
+    double amount;
+    Ship_handle requester;
+    std::function<void(double)> deliver;
+  };
+  std::vector<Fuel_request> fuel_requests;
+  std::vector<Ship*> berths; // the ships docked here
 
+  static const std::string TYPE_NAME;
   static const int UNIT_TIME; //time unit // NOTE: DON'T USE ALL CAPITALIZE FOR CONST VARS, QUESTION: NECESSARY?
 };
 #endif
@@ -0,0 +1,93 @@
+#include "Island_registry.h"
+#include "Island.h"
+#include <functional>
+#include <algorithm>
+using std::vector;
+using std::shared_ptr;
+
+// index the islands, which are in name order
+Island_registry::Island_registry(const vector<shared_ptr<Island>>& islands_)
+  :islands(islands_)
+{
+  // the first island at a location keeps it
+  for (int i = 0; i < int(islands.size()); ++i) {
+    indices.insert(std::make_pair(islands[i]->get_location(), i));
+  }
+}
+
+// the index of the island, which must be in the registry
+int Island_registry::index_of(const Island& island) const
+{
+  auto it = std::lower_bound(islands.begin(), islands.end(), island.get_name(),
+    [](const shared_ptr<Island>& entry, const std::string& name) {return entry->get_name() < name;});
+  return int(it - islands.begin());
+}
+
+// the index of the island at exactly the location, or NO_ISLAND if none
+int Island_registry::find(Point location) const
+{
+  auto it = indices.find(location);
+  return it != indices.end() ? it->second : NO_ISLAND;
+}
+
+// the islands of the optimized tour from the start island, starting with it
+std::shared_ptr<const vector<int>> Island_registry::get_tour(int start) const
+{
+  auto cached = tours.find(start);
+  if (cached != tours.end()) return cached->second;
+  int count = size();
+  if (distances.empty()) {
+    distances.resize(count * count);
+    for (int from = 0; from < count; ++from) {
+      for (int to = 0; to < count; ++to) {
+        distances[from * count + to] = cartesian_distance(islands[from]->get_location(), islands[to]->get_location());
+      }
+    }
+  }
+  // nearest neighbor, the first in name order on a tie
+  vector<int> tour(1, start);
+  vector<bool> visited(count);
+  visited[start] = true;
+  for (int stop = 1; stop < count; ++stop) {
+    int from = tour.back(), next = NO_ISLAND;
+    for (int i = 0; i < count; ++i) {
+      if (!visited[i] && (next == NO_ISLAND || distance(from, i) < distance(from, next))) next = i;
+    }
+    visited[next] = true;
+    tour.push_back(next);
+  }
+  improve_tour(tour);
+  shared_ptr<const vector<int>> result = std::make_shared<const vector<int>>(std::move(tour));
+  tours[start] = result;
+  return result;
+}
+
+// 2-opt: reverse tour[i..j] whenever joining tour[i-1] to tour[j] and tour[i] to
+// the island after tour[j] is shorter; the start stays first
+void Island_registry::improve_tour(vector<int>& tour) const
+{
+  int count = int(tour.size());
+  bool improved = true;
+  while (improved) {
+    improved = false;
+    for (int i = 1; i < count - 1; ++i) {
+      for (int j = i + 1; j < count; ++j) {
+        int before = tour[i - 1], after = tour[(j + 1) % count];
+        double change = distance(before, tour[j]) + distance(tour[i], after)
+          - distance(before, tour[i]) - distance(tour[j], after);
+        // a margin keeps rounding from reversing forever
+        if (change < -1e-9) {
+          std::reverse(tour.begin() + i, tour.begin() + j + 1);
+          improved = true;
+        }
+      }
+    }
+  }
+}
+
+// equal points hash the same, as 0. and -0. do
+std::size_t Island_registry::Point_hash::operator() (const Point& point) const
+{
+  std::hash<double> hash;
+  return hash(point.x) * 31 + hash(point.y);
+}
@@ -0,0 +1,68 @@
+/* Island_registry
+The Island_registry is the one list of the islands that every Cruise_ship shares,
+instead of each keeping its own copy. Each island has a dense index, its place in
+name order, so that per-ship state about islands can be a vector of flags indexed
+by it. The island at a location is found by hashing the location.
+
+The registry also plans cruise tours: from a start island, every other island
+once and back, built by nearest neighbor - the order the legacy greedy cruise
+takes - then shortened by 2-opt. A tour is planned once per start island and
+shared by every Cruise_ship that asks for it; the registry never changes, so the
+cached tours stay valid as long as it lasts.
+
+The Model builds the registry once its islands are in place; islands are never
+added afterward.
+*/
+#ifndef ISLAND_REGISTRY_H
+#define ISLAND_REGISTRY_H
+#include "Geometry.h"
+#include <vector>
+#include <memory>
+#include <unordered_map>
+#include <map>
+
+class Island;
+
+class Island_registry {
+public:
+  static const int NO_ISLAND = -1;
+
+  // index the islands, which are in name order
+  Island_registry(const std::vector<std::shared_ptr<Island>>& islands_);
+
+  int size() const {return int(islands.size());}
+  const std::shared_ptr<Island>& operator[] (int index) const {return islands[index];}
+
+  // the index of the island, which must be in the registry
+  int index_of(const Island& island) const;
+
+  // the index of the island at exactly the location, the first in name order
+  // if there are several, or NO_ISLAND if none
+  int find(Point location) const;
+
+  // the islands of the optimized tour from the start island, starting with it
+  std::shared_ptr<const std::vector<int>> get_tour(int start) const;
+
+  // disallow copy/move construction or assignment
+  Island_registry(const Island_registry&) = delete;
+  Island_registry(Island_registry&&) = delete;
+  Island_registry& operator= (const Island_registry&) = delete;
+  Island_registry& operator= (Island_registry&&) = delete;
+
+private:
+  struct Point_hash {
+    std::size_t operator() (const Point& point) const;
+  };
+
+  std::vector<std::shared_ptr<Island>> islands;
+  std::unordered_map<Point, int, Point_hash> indices; // by location
+  // the distances between islands, by index, computed with the first tour
+  mutable std::vector<double> distances;
+  mutable std::map<int, std::shared_ptr<const std::vector<int>>> tours; // by start
+
+  double distance(int from, int to) const {return distances[from * islands.size() + to];}
+  // improve the closed tour by reversing segments while that shortens it
+  void improve_tour(std::vector<int>& tour) const;
+};
+
+#endif
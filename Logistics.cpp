@@ -0,0 +1,94 @@
+#include "Logistics.h"
+#include "Tanker.h"
+#include "Island.h"
+#include "Island_registry.h"
+#include "Model.h"
+#include "Geometry.h"
+#include <algorithm>
+using std::vector;
+using std::shared_ptr;
+
+// the hours over which a supply island's stock counts toward what it can give per hour
+static const double STOCK_HORIZON = 24.;
+// the hours per cycle spent docking, loading and unloading
+static const double HANDLING_TIME = 4.;
+// the fraction by which another pair must be better for a Tanker to leave its current one
+static const double KEEP_MARGIN = .1;
+
+// schedule the tankers between the supply and the demand islands
+Logistics::Logistics(const vector<shared_ptr<Tanker>>& tankers_,
+    const vector<shared_ptr<Island>>& supplies_, const vector<shared_ptr<Island>>& demands_)
+{
+  const Island_registry& islands = Model::get_Instance().get_island_registry();
+  for (auto& tanker : tankers_) tankers.push_back(tanker->get_handle());
+  for (auto& supply : supplies_) supplies.push_back(islands.index_of(*supply));
+  for (auto& demand : demands_) demands.push_back(islands.index_of(*demand));
+  distances.reserve(supplies.size() * demands.size());
+  for (int supply : supplies) {
+    for (int demand : demands) {
+      distances.push_back(cartesian_distance(islands[supply]->get_location(), islands[demand]->get_location()));
+    }
+  }
+}
+
+// assign each Tanker that can move to its best pair of a supply and a demand island
+void Logistics::assign()
+{
+  Model& model = Model::get_Instance();
+  const Island_registry& islands = model.get_island_registry();
+  // the tons per hour each supply island has left to give
+  vector<double> supply_left;
+  supply_left.reserve(supplies.size());
+  for (int supply : supplies) {
+    supply_left.push_back(islands[supply]->get_production_rate() + islands[supply]->get_fuel() / STOCK_HORIZON);
+  }
+  for (Ship_handle handle : tankers) {
+    // only Tankers are given to Logistics, and a later ship in the slot has another generation
+    Tanker* tanker = static_cast<Tanker*>(model.get_ship(handle));
+    if (!tanker || !tanker->can_move()) continue;
+    Point position = tanker->get_location();
+    bool loaded = tanker->get_cargo() > 0.;
+    std::size_t best = 0, current = 0;
+    double best_value = 0., best_taken = 0., current_value = -1., current_taken = 0.;
+    for (std::size_t s = 0; s < supplies.size(); ++s) {
+      for (std::size_t d = 0; d < demands.size(); ++d) {
+        if (supplies[s] == demands[d]) continue;
+        double rate = cycle_rate(*tanker, s, d);
+        double taken = std::min(rate, supply_left[s]);
+        // the first delivery is later by the time to reach where the cycle starts
+        Point start = islands[loaded ? demands[d] : supplies[s]]->get_location();
+        double reach = cartesian_distance(position, start) / tanker->get_cargo_speed();
+        double cycle = tanker->get_cargo_capacity() / rate;
+        double value = taken * cycle / (cycle + reach);
+        std::size_t pair = s * demands.size() + d;
+        if (value > best_value) {
+          best = pair;
+          best_value = value;
+          best_taken = taken;
+        }
+        if (supplies[s] == tanker->get_load_destination() && demands[d] == tanker->get_unload_destination()) {
+          current = pair;
+          current_value = value;
+          current_taken = taken;
+        }
+      }
+    }
+    if (current_value >= 0. && current_value >= best_value * (1. - KEEP_MARGIN)) {
+      best = current;
+      best_value = current_value;
+      best_taken = current_taken;
+    }
+    // with every supply taken, the Tanker carries on as it is
+    if (best_value <= 0.) continue;
+    std::size_t supply = best / demands.size(), demand = best % demands.size();
+    supply_left[supply] -= best_taken;
+    tanker->set_cargo_destinations(supplies[supply], demands[demand]);
+  }
+}
+
+// delivered tons per hour of a tanker on the pair, not counting the supply
+double Logistics::cycle_rate(const Tanker& tanker, std::size_t supply, std::size_t demand) const
+{
+  double cycle = 2. * distances[supply * demands.size() + demand] / tanker.get_cargo_speed() + HANDLING_TIME;
+  return tanker.get_cargo_capacity() / cycle;
+}
@@ -0,0 +1,52 @@
+/* Logistics
+Logistics schedules a fleet of Tankers to carry fuel from a set of supply islands
+to a set of demand islands. Each time assign() is called it gives every Tanker that
+can move the pair of a supply and a demand island where it adds the most delivered
+tons per hour, and the Tanker starts its cargo cycle between them.
+
+A Tanker on a pair delivers its cargo capacity once per cycle: the round trip at
+its cargo speed plus the time to dock, load and unload. A supply island can only
+give what it produces per hour, plus its stock spread over STOCK_HORIZON hours, so
+once the tankers already assigned take all of a supply island's fuel, further
+tankers are better off elsewhere. The time to reach the supply island first
+discounts a pair, so that tankers stay near where they are.
+
+The solver is greedy, in the order the Tankers were given: each takes its best
+pair given the supply the earlier ones have taken. A Tanker keeps its current pair
+unless another is better by more than KEEP_MARGIN, so that the cargo cycles are not
+restarted for small gains. The islands do not move, so the distances between
+them are computed once; an assignment costs one pass over the pairs per Tanker.
+*/
+#ifndef LOGISTICS_H
+#define LOGISTICS_H
+#include "Ship_handle.h"
+#include <vector>
+#include <memory>
+
+class Tanker;
+class Island;
+
+class Logistics {
+public:
+  // schedule the tankers between the supply and the demand islands
+  Logistics(const std::vector<std::shared_ptr<Tanker>>& tankers_,
+    const std::vector<std::shared_ptr<Island>>& supplies_,
+    const std::vector<std::shared_ptr<Island>>& demands_);
+
+  // assign each Tanker that can move to its best pair of a supply and a demand island
+  void assign();
+
+private:
+  // a Tanker that has sunk is skipped from then on
+  std::vector<Ship_handle> tankers;
+  // the islands by index in the Model's island registry
+  std::vector<int> supplies;
+  std::vector<int> demands;
+  // the distance from each supply island to each demand island, by supply then demand
+  std::vector<double> distances;
+
+  // delivered tons per hour of a tanker on the pair, not counting the supply
+  double cycle_rate(const Tanker& tanker, std::size_t supply, std::size_t demand) const;
+};
+
+#endif
@@ -0,0 +1,127 @@
+#include "Metrics.h"
+#include "Utility.h"
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <typeinfo>
+#include <cxxabi.h>
+#include <cstdlib>
+using std::string;
+using std::ostream;
+using std::endl;
+
+// add a duration in nanoseconds
+void Metrics::Histogram::record(long long nanoseconds)
+{
+  if (nanoseconds < 0) nanoseconds = 0;
+  if (!count || nanoseconds < minimum) minimum = nanoseconds;
+  if (nanoseconds > maximum) maximum = nanoseconds;
+  ++count;
+  total += nanoseconds;
+  int bucket = 0;
+  for (unsigned long long n = nanoseconds; n; n >>= 1) ++bucket;
+  ++buckets[bucket < BUCKETS ? bucket : BUCKETS - 1];
+}
+
+// get the instance
+Metrics& Metrics::get_Instance()
+{
+  static Metrics metrics;
+  return metrics;
+}
+
+Metrics::Metrics()
+  :dump_interval(0)
+{}
+
+// the file closes when destroyed
+Metrics::~Metrics()
+{}
+
+// the measurement of that name, registered if new
+Metrics::Counter* Metrics::get_counter(const string& name)
+{
+  return &counters[name];
+}
+
+Metrics::Gauge* Metrics::get_gauge(const string& name)
+{
+  return &gauges[name];
+}
+
+Metrics::Histogram* Metrics::get_histogram(const string& name)
+{
+  return &histograms[name];
+}
+
+// the upper end of the bucket holding the given fraction of the durations, in nanoseconds
+static long long percentile(const Metrics::Histogram& histogram, double fraction)
+{
+  long long rank = (long long)(fraction * histogram.count);
+  long long seen = 0;
+  for (int i = 0; i < Metrics::Histogram::BUCKETS; ++i) {
+    seen += histogram.buckets[i];
+    if (seen > rank) return i ? (1LL << i) - 1 : 0;
+  }
+  return histogram.maximum;
+}
+
+// output every measurement, in order of kind and name
+void Metrics::print(ostream& os) const
+{
+  os << "----- Stats -----" << endl;
+  for (auto& counter : counters) {
+    os << counter.first << ": " << counter.second.value << endl;
+  }
+  for (auto& gauge : gauges) {
+    os << gauge.first << ": " << gauge.second.value << endl;
+  }
+  // durations in microseconds; the histograms of what has not happened are left out
+  for (auto& entry : histograms) {
+    const Histogram& histogram = entry.second;
+    if (!histogram.count) continue;
+    os << entry.first << ": count " << histogram.count
+      << ", mean " << histogram.total / 1000. / histogram.count
+      << " us, min " << histogram.minimum / 1000.
+      << " us, p50 < " << percentile(histogram, .5) / 1000.
+      << " us, p99 < " << percentile(histogram, .99) / 1000.
+      << " us, max " << histogram.maximum / 1000. << " us" << endl;
+  }
+}
+
+// every interval ticks, append the measurements to the file
+void Metrics::start_dump(const string& filename, int interval)
+{
+  std::unique_ptr<std::ofstream> file(new std::ofstream(filename, std::ios::app));
+  if (!*file)
+    throw Error("Cannot open output file!");
+  file->setf(std::ios::fixed, std::ios::floatfield);
+  file->precision(2);
+  dump_file = std::move(file);
+  dump_interval = interval;
+}
+
+// stop dumping and close the file
+void Metrics::stop_dump()
+{
+  dump_file.reset();
+  dump_interval = 0;
+}
+
+// append the measurements to the dump file
+void Metrics::dump(int time)
+{
+  *dump_file << "Time " << time << endl;
+  print(*dump_file);
+}
+
+// the name of the dynamic type, demangled, for naming measurements by class
+string type_name_of(const std::type_info& type)
+{
+  int status = 0;
+  char* demangled = abi::__cxa_demangle(type.name(), nullptr, nullptr, &status);
+  if (status || !demangled) return type.name();
+  string name(demangled);
+  std::free(demangled);
+  return name;
+}
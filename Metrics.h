@@ -0,0 +1,91 @@
+/* Metrics
+Metrics is the registry of the engine's built-in measurements: counters that only
+go up, gauges that hold the latest value, and histograms of durations. Each is
+registered under a name the first time it is asked for, and stays at the same
+address from then on, so code that measures often keeps a pointer to it instead
+of looking it up by name each time.
+
+A histogram sorts durations into buckets by powers of two of nanoseconds, which is
+enough to tell a microsecond from a millisecond at the cost of one increment.
+
+The stats command prints every measurement; a dump file receives the same text
+every so many ticks.
+*/
+#ifndef METRICS_H
+#define METRICS_H
+#include <string>
+#include <map>
+#include <memory>
+#include <iosfwd>
+#include <chrono>
+#include <typeinfo>
+
+class Metrics {
+public:
+  struct Counter {
+    long long value = 0;
+  };
+  struct Gauge {
+    double value = 0.;
+  };
+  struct Histogram {
+    static const int BUCKETS = 64;
+    long long count = 0;
+    long long total = 0;        // nanoseconds
+    long long minimum = 0;
+    long long maximum = 0;
+    long long buckets[BUCKETS] = {}; // bucket i counts durations in [2^(i-1), 2^i) ns
+    // add a duration in nanoseconds
+    void record(long long nanoseconds);
+  };
+
+  // get the instance
+  static Metrics& get_Instance();
+
+  // the measurement of that name, registered if new
+  Counter* get_counter(const std::string& name);
+  Gauge* get_gauge(const std::string& name);
+  Histogram* get_histogram(const std::string& name);
+
+  // the current time in nanoseconds, for measuring durations
+  static long long now()
+    {return std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now().time_since_epoch()).count();}
+
+  // output every measurement, in order of kind and name
+  void print(std::ostream& os) const;
+
+  // every interval ticks, append the measurements to the file
+  // will throw Error("Cannot open output file!")
+  void start_dump(const std::string& filename, int interval);
+  // stop dumping and close the file
+  void stop_dump();
+  bool is_dumping() const {return bool(dump_file);}
+  // true if the measurements are to be dumped at the end of this tick
+  bool is_dump_due(int time) const {return dump_file && time % dump_interval == 0;}
+  // append the measurements to the dump file
+  void dump(int time);
+
+  // disallow copy/move construction or assignment
+  Metrics(const Metrics&) = delete;
+  Metrics(Metrics&&) = delete;
+  Metrics& operator= (const Metrics&) = delete;
+  Metrics& operator= (Metrics&&) = delete;
+
+private:
+  std::map<std::string, Counter> counters;
+  std::map<std::string, Gauge> gauges;
+  std::map<std::string, Histogram> histograms;
+  std::unique_ptr<std::ofstream> dump_file;
+  int dump_interval;
+
+  // private constructor
+  Metrics();
+  // the file closes when destroyed
+  ~Metrics();
+};
+
+// the name of the dynamic type, demangled, for naming measurements by class
+std::string type_name_of(const std::type_info& type);
+
+#endif
@@ -1,6 +1,8 @@
 #include "Model.h"
 #include "Sim_object.h"
 #include "Island.h"
+#include "Island_registry.h"
+#include "Spatial_grid.h"
 #include "Ship.h"
 #include "View.h"
 #include "Geometry.h"
@@ -30,31 +32,41 @@ Model& Model::get_Instance()
 
 // create the initial objects, output constructor message
 Model::Model()
-  :time(0)
+  :time(0), ships_version(0), ship_slots(1, Ship_slot{nullptr, 0}),
+  ticks_run(Metrics::get_Instance().get_counter("ticks run")),
+  tick_time(Metrics::get_Instance().get_histogram("tick time")),
+  update_order_version(~0u),
+  next_trigger_id(0), next_tick_task_id(0), command_queue_closed(false),
+  applying_commands(false)
 {
   insert_island(shared_ptr<Island>(new Island ("Exxon", Point(10, 10), 1000, 200)));
   insert_island(shared_ptr<Island>(new Island ("Shell", Point(0, 30), 1000, 200)));
   insert_island(shared_ptr<Island>(new Island ("Bermuda", Point(20, 20))));
   insert_island(shared_ptr<Island>(new Island ("Treasure_Island", Point(50, 5), 100, 5)));
+  island_registry.reset(new Island_registry(get_islands()));
  
   insert_ship(create_ship("Ajax", "Cruiser", Point (15, 15)));
   insert_ship(create_ship("Xerxes", "Cruiser", Point (25, 25)));
   insert_ship(create_ship("Valdez", "Tanker", Point (30, 30)));
 }
 
+// the ships go before the islands they may be docked at
+Model::~Model()
+{
+  for (auto& ship : ships) sim_objects.erase(ship.first);
+  ships.clear();
+  removed_ships.clear();
+}
+
 // is name already in use for either ship or island?
 // either the identical name, or identical in first two characters counts as in-use
 bool Model::is_name_in_use(const string& name) const
 { 
-  //NOTE: CAN DEFINE MAPS COMPARATOR TO COMPARE FIRST TWO CHARS, 2 IS MAGIC NUMBER
-  //NOTE: USE SET? USE LOWERBOUND ON THE FIRST TWO CHAR OF NAME
+  //NOTE: 2 IS MAGIC NUMBER
   string starting_two = name.substr(0, 2); //should have no problem since Controller checked size() >= 2
-  for (auto ptr : sim_objects) {
-    if (!ptr.second->get_name().compare(0, 2, starting_two)) {
-      return true;
-    }
-  }
-  return false;
+  // the first name not less than the first two characters starts with them, if any does
+  auto it = sim_objects.lower_bound(starting_two);
+  return it != sim_objects.end() && !it->first.compare(0, 2, starting_two);
 }
 
 // is there such an island?
@@ -76,6 +88,13 @@ shared_ptr<Island> Model::get_island_ptr(const string& name) const
   throw Error("Island not found!");
 }
 
+// return nullptr if no island of that name
+shared_ptr<Island> Model::find_island(const string& name) const
+{
+  auto it = islands.find(name);
+  return it != islands.end() ? it->second : nullptr;
+}
+
 // will return all the islands' pointer as a list
 std::vector<std::shared_ptr<Island>> Model::get_islands() const
 {
@@ -99,14 +118,53 @@ void Model::add_ship(shared_ptr<Ship> new_ship)
 {
   insert_ship(new_ship);
   // update the view
+  notify_ship_type(new_ship->get_name(), new_ship->get_type_name());
   new_ship->broadcast_current_state();
 }
 
-// remove the Ship from the containers
+// add new ships, in increasing order of name, to the list, and update the views
+// with one pass over each kind of subscriber
+void Model::add_ships(const vector<shared_ptr<Ship>>& new_ships)
+{
+  // each ship goes after the previous one, so the previous position is the hint
+  auto sim_object_hint = sim_objects.end();
+  auto ship_hint = ships.end();
+  for (auto& ship_ptr : new_ships) {
+    sim_object_hint = ++sim_objects.insert(sim_object_hint, std::make_pair(ship_ptr->get_name(), ship_ptr));
+    ship_hint = ++ships.insert(ship_hint, std::make_pair(ship_ptr->get_name(), ship_ptr));
+    add_ship_slot(ship_ptr.get());
+    if (spatial_grid) spatial_grid->insert(ship_ptr.get());
+  }
+  ++ships_version;
+  // update the views
+  for (auto& subscriber : type_views) {
+    subscriber.notifications->value += new_ships.size();
+    for (auto& ship_ptr : new_ships) subscriber.view->update_ship_type(ship_ptr->get_name(), ship_ptr->get_type_name());
+  }
+  for (auto& subscriber : location_views) {
+    subscriber.notifications->value += new_ships.size();
+    for (auto& ship_ptr : new_ships) subscriber.view->update_location(ship_ptr->get_name(), ship_ptr->get_location());
+  }
+  for (auto& subscriber : fuel_views) {
+    subscriber.notifications->value += new_ships.size();
+    for (auto& ship_ptr : new_ships) subscriber.view->update_ship_fuel(ship_ptr->get_name(), ship_ptr->get_fuel());
+  }
+  for (auto& subscriber : course_views) {
+    subscriber.notifications->value += new_ships.size();
+    for (auto& ship_ptr : new_ships) subscriber.view->update_ship_course(ship_ptr->get_name(), ship_ptr->get_course());
+  }
+  for (auto& subscriber : speed_views) {
+    subscriber.notifications->value += new_ships.size();
+    for (auto& ship_ptr : new_ships) subscriber.view->update_ship_speed(ship_ptr->get_name(), ship_ptr->get_speed());
+  }
+}
+
+// mark the Ship removed; it leaves the containers once the updates of the tick are done
 void Model::remove_ship(shared_ptr<Ship> ship_ptr)
 {
-  sim_objects.erase(ship_ptr->get_name());
-  ships.erase(ship_ptr->get_name());
+  if (ship_ptr->is_removed()) return;
+  ship_ptr->mark_removed();
+  removed_ships.push_back(ship_ptr);
 }
 
 // will throw Error("Ship not found!") if no ship of that name
@@ -119,6 +177,13 @@ shared_ptr<Ship> Model::get_ship_ptr(const string& name) const
   throw Error("Ship not found!");
 }
 
+// return nullptr if no ship of that name
+shared_ptr<Ship> Model::find_ship(const string& name) const
+{
+  auto it = ships.find(name);
+  return it != ships.end() ? it->second : nullptr;
+}
+
 // tell all objects to describe themselves
 void Model::describe() const
 {
@@ -127,13 +192,206 @@ void Model::describe() const
           bind(&map<string, shared_ptr<Sim_object>>::value_type::second, _1)));
 }
 
-// increment the time, and tell all objects to update themselves
+// apply the queued commands, increment the time, and tell all objects to update themselves
 void Model::update()
 {
+  apply_queued_commands();
+  long long tick_start = Metrics::now();
   ++time;
-  for_each(sim_objects.begin(), sim_objects.end(),
-      bind(&Sim_object::update, 
-          bind(&map<string, shared_ptr<Sim_object>>::value_type::second, _1)));
+  // a ship removed meanwhile stays in place, so the order does not change during the loop
+  refresh_update_order();
+  for (auto& entry : update_order) {
+    if (entry.object->is_removed()) continue;
+    long long start = Metrics::now();
+    entry.object->update();
+    entry.update_time->record(Metrics::now() - start);
+  }
+  apply_removals();
+  settle_fuel_requests();
+  // a task may remove tasks, so the due ones are found first
+  vector<int> due_tasks;
+  for (auto& task : tick_tasks) {
+    if (time % task.interval == 0) due_tasks.push_back(task.id);
+  }
+  for (int id : due_tasks) {
+    auto task = std::find_if(tick_tasks.begin(), tick_tasks.end(),
+      [id](const Tick_task& tick_task) {return tick_task.id == id;});
+    if (task != tick_tasks.end()) task->task();
+  }
+  run_fired_triggers();
+  notify_tick();
+  ++ticks_run->value;
+  tick_time->record(Metrics::now() - tick_start);
+  Metrics& metrics = Metrics::get_Instance();
+  if (metrics.is_dump_due(time)) {
+    measure();
+    metrics.dump(time);
+  }
+}
+
+// have every island settle its waiting fuel requests
+void Model::settle_fuel_requests()
+{
+  for (auto& island : islands) {
+    island.second->settle_fuel_requests();
+  }
+}
+
+// set the gauges of the ships in each state, and of the objects and views
+void Model::measure() const
+{
+  for (auto& gauge : ship_state_gauges) {
+    gauge.second->value = 0;
+  }
+  for (auto& ship : ships) {
+    const char* state = ship.second->get_state_name();
+    auto it = ship_state_gauges.find(state);
+    if (it == ship_state_gauges.end())
+      it = ship_state_gauges.insert(std::make_pair(string(state),
+        Metrics::get_Instance().get_gauge(string("ships ") + state))).first;
+    ++it->second->value;
+  }
+  Metrics::get_Instance().get_gauge("objects")->value = sim_objects.size();
+  Metrics::get_Instance().get_gauge("views")->value = views.size();
+}
+
+// add a trigger for the ship, which must be present; return its id
+int Model::add_trigger(const string& ship_name, unsigned event, std::function<void()> command)
+{
+  Trigger trigger = {next_trigger_id++, ship_name, event, std::move(command)};
+  triggers.push_back(std::move(trigger));
+  watch_events(ship_name);
+  return triggers.back().id;
+}
+
+// discard the trigger if it has not fired
+void Model::remove_trigger(int id)
+{
+  auto it = std::find_if(triggers.begin(), triggers.end(),
+    [id](const Trigger& trigger) {return trigger.id == id;});
+  if (it == triggers.end()) return;
+  string ship_name = it->ship_name;
+  triggers.erase(it);
+  watch_events(ship_name);
+}
+
+// the ship has had the event: fire the triggers waiting for it
+void Model::notify_event(const string& ship_name, unsigned event)
+{
+  auto fired = std::stable_partition(triggers.begin(), triggers.end(),
+    [&ship_name, event](const Trigger& trigger) {return !(trigger.ship_name == ship_name && (trigger.event & event));});
+  for (auto it = fired; it != triggers.end(); ++it) {
+    fired_triggers.push_back(std::move(it->command));
+  }
+  triggers.erase(fired, triggers.end());
+  watch_events(ship_name);
+}
+
+// run the commands of the fired triggers, including any that fire meanwhile
+void Model::run_fired_triggers()
+{
+  while (!fired_triggers.empty()) {
+    vector<std::function<void()>> commands;
+    commands.swap(fired_triggers);
+    for (auto& command : commands) {
+      command();
+    }
+  }
+}
+
+// set the events the ship watches to those its triggers wait for
+void Model::watch_events(const string& ship_name)
+{
+  auto ship = ships.find(ship_name);
+  if (ship == ships.end()) return;
+  unsigned events = 0;
+  for (auto& trigger : triggers) {
+    if (trigger.ship_name == ship_name) events |= trigger.event;
+  }
+  ship->second->set_watched_events(events);
+}
+
+// the nearest ship to the point within the range for which accept is true, the
+// first in name order if there are several; nullptr if none
+Ship* Model::find_nearest_ship(Point point, double range,
+  const std::function<bool(const Ship&)>& accept)
+{
+  if (!spatial_grid) {
+    spatial_grid.reset(new Spatial_grid);
+    for (auto& ship : ships) spatial_grid->insert(ship.second.get());
+  }
+  return spatial_grid->find_nearest(point, range, accept);
+}
+
+// add a task run every interval ticks; return its id
+int Model::add_tick_task(int interval, std::function<void()> task)
+{
+  Tick_task tick_task = {next_tick_task_id++, interval, std::move(task)};
+  tick_tasks.push_back(std::move(tick_task));
+  return tick_tasks.back().id;
+}
+
+// discard the task
+void Model::remove_tick_task(int id)
+{
+  tick_tasks.erase(std::remove_if(tick_tasks.begin(), tick_tasks.end(),
+    [id](const Tick_task& tick_task) {return tick_task.id == id;}), tick_tasks.end());
+}
+
+// queue a command to be applied on the simulation's thread
+void Model::enqueue_command(int source, std::function<void()> command,
+  std::function<void(const char*)> report_failure)
+{
+  {
+    std::lock_guard<std::mutex> lock(command_queue_mutex);
+    command_queue.push_back(Queued_command{source, std::move(command), std::move(report_failure)});
+  }
+  command_queued.notify_one();
+}
+
+// apply the commands queued so far, by source and then in order of submission;
+// a tick run by one of them, such as by go, leaves the queue to the next boundary
+void Model::apply_queued_commands()
+{
+  if (applying_commands) return;
+  std::deque<Queued_command> commands;
+  {
+    std::lock_guard<std::mutex> lock(command_queue_mutex);
+    commands.swap(command_queue);
+  }
+  std::stable_sort(commands.begin(), commands.end(),
+    [](const Queued_command& a, const Queued_command& b) {return a.source < b.source;});
+  applying_commands = true;
+  for (auto& queued : commands) {
+    try {
+      queued.command();
+    } catch (Error& e) {
+      queued.report_failure(e.what());
+    } catch (...) {
+      applying_commands = false;
+      throw;
+    }
+  }
+  applying_commands = false;
+}
+
+// wait until a command is queued or the queue is closed;
+// return false if the queue is closed and empty
+bool Model::wait_for_queued_commands()
+{
+  std::unique_lock<std::mutex> lock(command_queue_mutex);
+  command_queued.wait(lock, [this] {return !command_queue.empty() || command_queue_closed;});
+  return !command_queue.empty();
+}
+
+// no more commands will be queued
+void Model::close_command_queue()
+{
+  {
+    std::lock_guard<std::mutex> lock(command_queue_mutex);
+    command_queue_closed = true;
+  }
+  command_queued.notify_all();
 }
 
 // Attaching a View adds it to the container and causes it to be updated
@@ -141,6 +399,20 @@ void Model::update()
 void Model::attach(shared_ptr<View> new_view)
 {
   views.push_back(new_view);
+  unsigned interests = new_view->get_interests();
+  Subscriber subscriber = {new_view,
+    Metrics::get_Instance().get_counter("notifications to " + type_name_of(typeid(*new_view)))};
+  if (interests & View::LOCATION) location_views.push_back(subscriber);
+  if (interests & View::SPEED) speed_views.push_back(subscriber);
+  if (interests & View::COURSE) course_views.push_back(subscriber);
+  if (interests & View::FUEL) fuel_views.push_back(subscriber);
+  if (interests & View::REMOVE) remove_views.push_back(subscriber);
+  if (interests & View::TICK) tick_views.push_back(subscriber);
+  if (interests & View::TYPE) {
+    type_views.push_back(subscriber);
+    subscriber.notifications->value += ships.size();
+    for (auto& ship : ships) new_view->update_ship_type(ship.first, ship.second->get_type_name());
+  }
   for_each(sim_objects.begin(), sim_objects.end(), 
       bind(&Sim_object::broadcast_current_state, 
           bind(&map<string, shared_ptr<Sim_object>>::value_type::second, _1)));
@@ -151,36 +423,66 @@ void Model::attach(shared_ptr<View> new_view)
 void Model::detach(shared_ptr<View> view_ptr)
 {
   views.erase(find(views.begin(), views.end(), view_ptr)); //no need to delete the obj
+  for (auto subscribers : {&location_views, &speed_views, &course_views, &fuel_views, &remove_views, &tick_views, &type_views}) {
+    auto it = find_if(subscribers->begin(), subscribers->end(),
+      [&view_ptr](const Subscriber& subscriber) {return subscriber.view == view_ptr;});
+    if (it != subscribers->end()) subscribers->erase(it);
+  }
 }
 
 // notify the views about an object's location
 void Model::notify_location(const std::string& name, Point location)
 {
-  for_each(views.begin(), views.end(), bind(&View::update_location, _1, std::ref(name), location));
+  if (spatial_grid) spatial_grid->move(name, location);
+  for (auto& subscriber : location_views) {
+    ++subscriber.notifications->value;
+    subscriber.view->update_location(name, location);
+  }
 }
 
 // update ship's speed 
 void Model::notify_ship_speed(const std::string& name, double value)
 {
-  for_each(views.begin(), views.end(), bind(&View::update_ship_speed, _1, std::ref(name), value));
+  for (auto& subscriber : speed_views) {
+    ++subscriber.notifications->value;
+    subscriber.view->update_ship_speed(name, value);
+  }
 }
 
 // update ship's course 
 void Model::notify_ship_course(const std::string& name, double value)
 {
-  for_each(views.begin(), views.end(), bind(&View::update_ship_course, _1, std::ref(name), value));
+  for (auto& subscriber : course_views) {
+    ++subscriber.notifications->value;
+    subscriber.view->update_ship_course(name, value);
+  }
 }
 
 // update ship's fuel
 void Model::notify_ship_fuel(const std::string& name, double value)
 {
-  for_each(views.begin(), views.end(), bind(&View::update_ship_fuel, _1, std::ref(name), value));
+  for (auto& subscriber : fuel_views) {
+    ++subscriber.notifications->value;
+    subscriber.view->update_ship_fuel(name, value);
+  }
 }
 
-// notify the views that an object is now gone
-void Model::notify_gone(const string& name)
+// tell the views a new ship's type, before its first location
+void Model::notify_ship_type(const std::string& name, const std::string& type_name)
 {
-  for_each(views.begin(), views.end(), bind(&View::update_remove, _1, std::ref(name)));
+  for (auto& subscriber : type_views) {
+    ++subscriber.notifications->value;
+    subscriber.view->update_ship_type(name, type_name);
+  }
+}
+
+// notify the views that every object has been updated for this tick
+void Model::notify_tick()
+{
+  for (auto& subscriber : tick_views) {
+    ++subscriber.notifications->value;
+    subscriber.view->update_tick(time);
+  }
 }
 
 // insert an island to its containers
@@ -195,4 +497,70 @@ void Model::insert_ship(shared_ptr<Ship> ship_ptr)
 {
   sim_objects.insert(std::pair<string, shared_ptr<Sim_object>>(ship_ptr->get_name(), ship_ptr));
   ships.insert(std::pair<string, shared_ptr<Ship>>(ship_ptr->get_name(), ship_ptr));
+  ++ships_version;
+  add_ship_slot(ship_ptr.get());
+  if (spatial_grid) spatial_grid->insert(ship_ptr.get());
+}
+
+// give the ship a free slot in the table and its handle
+void Model::add_ship_slot(Ship* ship)
+{
+  unsigned slot;
+  if (free_ship_slots.empty()) {
+    slot = ship_slots.size();
+    ship_slots.push_back(Ship_slot{nullptr, 0});
+  } else {
+    slot = free_ship_slots.back();
+    free_ship_slots.pop_back();
+  }
+  ship_slots[slot].ship = ship;
+  ship->set_handle(Ship_handle(slot, ship_slots[slot].generation));
+}
+
+// rebuild the update order if ships have been added or removed since
+void Model::refresh_update_order()
+{
+  if (update_order_version == ships_version) return;
+  update_order.clear();
+  update_order.reserve(sim_objects.size());
+  for (auto& object : sim_objects) {
+    // the time per update by the concrete type of the object
+    const string& type_name = object.second->get_type_name();
+    auto it = update_times.find(&type_name);
+    if (it == update_times.end())
+      it = update_times.insert(std::make_pair(&type_name,
+        Metrics::get_Instance().get_histogram("update " + type_name))).first;
+    update_order.push_back(Update_entry{object.second.get(), it->second});
+  }
+  update_order_version = ships_version;
+}
+
+// take the removed ships out of the containers, and notify the views that they are
+// gone with one pass over each subscriber
+void Model::apply_removals()
+{
+  if (removed_ships.empty()) return;
+  for (auto& ship_ptr : removed_ships) {
+    const string& name = ship_ptr->get_name();
+    sim_objects.erase(name);
+    ships.erase(name);
+    // handles to the ship no longer match
+    Ship_slot& slot = ship_slots[ship_ptr->get_handle().slot];
+    slot.ship = nullptr;
+    ++slot.generation;
+    free_ship_slots.push_back(ship_ptr->get_handle().slot);
+    if (spatial_grid) spatial_grid->remove(name);
+  }
+  ++ships_version;
+  // the triggers die with the ship; a later ship of the same name starts without any
+  if (!triggers.empty()) {
+    triggers.erase(std::remove_if(triggers.begin(), triggers.end(),
+      [this](const Trigger& trigger) {return !ships.count(trigger.ship_name);}),
+      triggers.end());
+  }
+  for (auto& subscriber : remove_views) {
+    subscriber.notifications->value += removed_ships.size();
+    for (auto& ship_ptr : removed_ships) subscriber.view->update_remove(ship_ptr->get_name());
+  }
+  removed_ships.clear();
 }
@@ -10,6 +10,16 @@ Finally, it keeps the system's time.
 Controller tells Model what to do; Model in turn tells the objects what do, and
 when asked to do so by an object, tells all the Views whenever anything changes that might be relevant.
 Model also provides facilities for looking up objects given their name.
+
+Each tick the objects update one at a time in order of name, each through its
+virtual update(), and the order is part of the simulation, not only of the output.
+Under FIFO, a Tanker or a refueling ship takes fuel from an Island at once, so
+it sees that tick's production only if the Island comes first. A Warship's shot
+sinks a ship whether or not that ship has updated yet. A patrol picks its target
+from the locations the ships ahead of it have already moved to. Running the
+objects in per-type batches would change these outcomes, and merging the output
+back into name order could not restore them. So the updates stay in name order;
+the order is kept in a flat vector so that a tick does not walk the map of objects.
 */
 #ifndef MODEL_H
 #define MODEL_H
@@ -17,11 +27,19 @@ Model also provides facilities for looking up objects given their name.
 #include <map>
 #include <vector>
 #include <memory>
+#include <functional>
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+#include "Metrics.h"
+#include "Ship_handle.h"
 struct Point;
 class Sim_object;
 class Island;
 class Ship;
 class View;
+class Island_registry;
+class Spatial_grid;
 
 // Declare the global model pointer
 class Model; //NOTE: DELETE
@@ -42,26 +60,103 @@ public:
   bool is_island_present(const std::string& name) const;
   // will throw Error("Island not found!") if no island of that name
   std::shared_ptr<Island> get_island_ptr(const std::string& name) const;
+  // return nullptr if no island of that name
+  std::shared_ptr<Island> find_island(const std::string& name) const;
   // will return all the islands' pointer as a list
   std::vector<std::shared_ptr<Island>> get_islands() const;
+  // the islands indexed densely in name order, shared by all who need them
+  const Island_registry& get_island_registry() const {return *island_registry;}
 
   // is there such an ship?
   bool is_ship_present(const std::string& name) const;
   // add a new ship to the list, and update the view
   void add_ship(std::shared_ptr<Ship>);
-  // remove the Ship from the containers
+  // add new ships, in increasing order of name, to the list, and update the views
+  // with one pass over each kind of subscriber
+  void add_ships(const std::vector<std::shared_ptr<Ship>>& new_ships);
+  // mark the Ship removed; it stays in the containers, skipped, until the updates of
+  // the tick are done, then leaves them along with the others removed meanwhile
   void remove_ship(std::shared_ptr<Ship> ship_ptr);
   // will throw Error("Ship not found!") if no ship of that name
   std::shared_ptr<Ship> get_ship_ptr(const std::string& name) const;
+  // return nullptr if no ship of that name
+  std::shared_ptr<Ship> find_ship(const std::string& name) const;
+  // changes whenever a ship is added or removed, so that a ship looked up
+  // by name stays valid while the version is the same
+  unsigned get_ships_version() const {return ships_version;}
+  // the ship the handle names, or nullptr if it has been removed. Every ship added
+  // gets a slot in a table and the slot's current generation as its handle; removing
+  // the ship bumps the generation, so a handle to it no longer matches, and frees the
+  // slot for a later ship. Slot 0 is never used, so the default handle names no ship.
+  // A ship removed during the updates of a tick is destroyed once they are done, so
+  // a pointer to it obtained during them stays usable until then.
+  Ship* get_ship(Ship_handle handle) const
+    {const Ship_slot& slot = ship_slots[handle.slot];
+      return slot.generation == handle.generation ? slot.ship : nullptr;}
   
   // tell all objects to describe themselves
   void describe() const;
-  // increment the time, and tell all objects to update themselves
+  // apply the queued commands, increment the time, and tell all objects to update themselves
   void update();  
+  // set the gauges of the ships in each state, and of the objects and views
+  void measure() const;
+  // have every island settle its waiting fuel requests; done at the end of each
+  // tick, and by the Controller after each command
+  void settle_fuel_requests();
+
+  /* Command queue services */
+  // Commands may be queued from any thread, each from a numbered source. They are
+  // applied on the simulation's thread at tick boundaries: at the start of the next
+  // tick, or when it applies them between ticks. A boundary applies the commands
+  // queued before it in increasing order of source, and those of one source in order
+  // of submission. A tick run by one of those commands does not apply the queue
+  // again, so the commands queued meanwhile wait for the next boundary. A command
+  // that throws Error is reported through its report_failure with the error
+  // message, and the rest are still applied.
+  void enqueue_command(int source, std::function<void()> command,
+    std::function<void(const char*)> report_failure);
+  // apply the commands queued so far; does nothing while already applying them
+  void apply_queued_commands();
+  // wait until a command is queued or the queue is closed;
+  // return false if the queue is closed and empty
+  bool wait_for_queued_commands();
+  // no more commands will be queued
+  void close_command_queue();
   
+  /* Trigger services */
+  // A trigger runs its command once, when the ship next has the event (a Ship::Event).
+  // Ships signal only the events they have triggers for, so ships without triggers
+  // cost nothing. The commands of the triggers that fire during a tick run at the
+  // end of the tick, and those that fire while a command executes run after it.
+  // add a trigger for the ship, which must be present; return its id
+  int add_trigger(const std::string& ship_name, unsigned event, std::function<void()> command);
+  // discard the trigger if it has not fired
+  void remove_trigger(int id);
+  // the ship has had the event: fire the triggers waiting for it
+  void notify_event(const std::string& ship_name, unsigned event);
+  // run the commands of the fired triggers, including any that fire meanwhile
+  void run_fired_triggers();
+
+  /* Spatial index services */
+  // The ships are indexed by location from the first time a ship asks for the ships
+  // near it; from then on the index follows them as they move, arrive and leave.
+  // the nearest ship to the point within the range for which accept is true, the
+  // first in name order if there are several; nullptr if none
+  Ship* find_nearest_ship(Point point, double range,
+    const std::function<bool(const Ship&)>& accept);
+
+  /* Tick task services */
+  // A tick task runs at the end of each tick whose time is a multiple of its
+  // interval, after the objects have updated.
+  // add a task; return its id
+  int add_tick_task(int interval, std::function<void()> task);
+  // discard the task
+  void remove_tick_task(int id);
+
   /* View services */
   // Attaching a View adds it to the container and causes it to be updated
   // with all current objects'location (or other state information.
+  // The View is subscribed only to the notifications in its get_interests().
   void attach(std::shared_ptr<View>);
   // Detach the View by discarding the supplied pointer from the container of Views
   // - no updates sent to it thereafter.
@@ -75,8 +170,10 @@ public:
   void notify_ship_course(const std::string& name, double value);
   // update ship's fuel
   void notify_ship_fuel(const std::string& name, double value);
-  // notify the views that an object is now gone
-  void notify_gone(const std::string& name);
+  // tell the views a new ship's type, before its first location
+  void notify_ship_type(const std::string& name, const std::string& type_name);
+  // notify the views that every object has been updated for this tick
+  void notify_tick();
 
   // disallow copy/move construction or assignment
   Model(const Model&) = delete;
@@ -86,25 +183,110 @@ public:
 
 private:
   int time;    // the simulated time
+  unsigned ships_version; // counts the additions and removals of ships
   
   // ordered container for sim_objects
   std::map<std::string, std::shared_ptr<Sim_object>> sim_objects; //NOTE: USE SET RECOMMENDED
   // ordered container for islands 
   std::map<std::string, std::shared_ptr<Island>> islands;
+  // built once the islands are all inserted
+  std::unique_ptr<Island_registry> island_registry;
   // ordered container for ships 
   std::map<std::string, std::shared_ptr<Ship>> ships;
+  // the table of ships for handles, and the free slots
+  struct Ship_slot {
+    Ship* ship;
+    unsigned generation;
+  };
+  std::vector<Ship_slot> ship_slots;
+  std::vector<unsigned> free_ship_slots;
+  // the ships removed during the updates of this tick, in order of removal
+  std::vector<std::shared_ptr<Ship>> removed_ships;
+  // the ships by location, built when first asked for
+  std::unique_ptr<Spatial_grid> spatial_grid;
   // container for views 
   std::vector<std::shared_ptr<View>> views; // NOTE: CAN USE SET, QUICKER DELETE
+  // a view subscribed to a kind of notification, and the count of notifications
+  // sent to views of its type
+  struct Subscriber {
+    std::shared_ptr<View> view;
+    Metrics::Counter* notifications;
+  };
+  // the views subscribed to each kind of notification, in attaching order
+  std::vector<Subscriber> location_views;
+  std::vector<Subscriber> speed_views;
+  std::vector<Subscriber> course_views;
+  std::vector<Subscriber> fuel_views;
+  std::vector<Subscriber> remove_views;
+  std::vector<Subscriber> tick_views;
+  std::vector<Subscriber> type_views;
+
+  // measurements of the ticks and the objects' updates
+  Metrics::Counter* ticks_run;
+  Metrics::Histogram* tick_time;
+  std::map<const std::string*, Metrics::Histogram*> update_times; // by the objects' type name
+  // the objects in order of name with the histograms of their types, rebuilt when
+  // a ship is added or removed, so that a tick is one pass over a vector
+  struct Update_entry {
+    Sim_object* object;
+    Metrics::Histogram* update_time;
+  };
+  std::vector<Update_entry> update_order;
+  unsigned update_order_version; // the ships_version update_order was built at
+  mutable std::map<std::string, Metrics::Gauge*> ship_state_gauges; // by state name
+
+  // the triggers waiting for their events, in order of adding, and the commands
+  // of those that have fired
+  struct Trigger {
+    int id;
+    std::string ship_name;
+    unsigned event;
+    std::function<void()> command;
+  };
+  std::vector<Trigger> triggers;
+  std::vector<std::function<void()>> fired_triggers;
+  int next_trigger_id;
+
+  // the tasks run every so many ticks, in order of adding
+  struct Tick_task {
+    int id;
+    int interval;
+    std::function<void()> task;
+  };
+  std::vector<Tick_task> tick_tasks;
+  int next_tick_task_id;
+
+  // the commands waiting to be applied, and what guards them
+  struct Queued_command {
+    int source;
+    std::function<void()> command;
+    std::function<void(const char*)> report_failure;
+  };
+  std::deque<Queued_command> command_queue;
+  std::mutex command_queue_mutex;
+  std::condition_variable command_queued;
+  bool command_queue_closed;
+  bool applying_commands; // true while a boundary's commands are being applied
 
   // private constructor 
   Model();
-  // NOTE: ~MODEL() SHOULD BE PRIVATE
+  // the ships go before the islands they may be docked at
+  ~Model();
 
   //helper
   // insert an island to its containers
   void insert_island(std::shared_ptr<Island> island);
   // insert a ship to its containers
   void insert_ship(std::shared_ptr<Ship> ship);
+  // give the ship a free slot in the table and its handle
+  void add_ship_slot(Ship* ship);
+  // take the removed ships out of the containers, and notify the views that they are
+  // gone with one pass over each subscriber
+  void apply_removals();
+  // set the events the ship watches to those its triggers wait for
+  void watch_events(const std::string& ship_name);
+  // rebuild the update order if ships have been added or removed since
+  void refresh_update_order();
   
 };
 
@@ -0,0 +1,35 @@
+#include "Pool_allocator.h"
+
+// blocks of at least the size, aligned as any object of the size needs
+Block_pool::Block_pool(std::size_t block_size_)
+  :free_list(nullptr), carved(BLOCKS_PER_CHUNK)
+{
+  // a free block holds the link to the next, and each block starts at a multiple
+  // of the strictest alignment from the chunk's start, which new[] aligns so
+  const std::size_t alignment = alignof(std::max_align_t);
+  block_size = block_size_ < sizeof(Free_block) ? sizeof(Free_block) : block_size_;
+  block_size = (block_size + alignment - 1) / alignment * alignment;
+}
+
+// a free block, reused if one has been freed
+void* Block_pool::allocate()
+{
+  if (free_list) {
+    Free_block* block = free_list;
+    free_list = block->next;
+    return block;
+  }
+  if (carved == BLOCKS_PER_CHUNK) {
+    chunks.emplace_back(new char[block_size * BLOCKS_PER_CHUNK]);
+    carved = 0;
+  }
+  return chunks.back().get() + block_size * carved++;
+}
+
+// the block goes on the free list
+void Block_pool::deallocate(void* block)
+{
+  Free_block* freed = static_cast<Free_block*>(block);
+  freed->next = free_list;
+  free_list = freed;
+}
@@ -0,0 +1,80 @@
+/* Pool_allocator
+A Pool_allocator takes single objects of a type from a pool of blocks of that
+type's size, instead of from the heap one by one. Given to std::allocate_shared,
+it gets the object and its shared_ptr control block in one block, so making a
+ship costs one allocation, and ships of the same type sit next to each other in
+the pool's chunks.
+
+A Block_pool carves BLOCKS_PER_CHUNK blocks at a time out of a chunk from the heap.
+A freed block goes on a free list, and the next allocation reuses it before
+carving a new one, so the blocks of sunk ships go to the ships created after them.
+Chunks are never given back, and the pools are never destroyed, so that the ships
+the Model destroys at exit can still return their blocks whatever the order of
+destruction of statics.
+
+The pools are not locked: ships are created and destroyed only on the simulation's
+thread.
+*/
+#ifndef POOL_ALLOCATOR_H
+#define POOL_ALLOCATOR_H
+#include <cstddef>
+#include <new>
+#include <vector>
+#include <memory>
+
+class Block_pool {
+public:
+  static const std::size_t BLOCKS_PER_CHUNK = 64;
+
+  // blocks of at least the size, aligned as any object of the size needs
+  explicit Block_pool(std::size_t block_size_);
+
+  // a free block, reused if one has been freed
+  void* allocate();
+  // the block goes on the free list
+  void deallocate(void* block);
+
+  // disallow copy/move construction or assignment
+  Block_pool(const Block_pool&) = delete;
+  Block_pool(Block_pool&&) = delete;
+  Block_pool& operator= (const Block_pool&) = delete;
+  Block_pool& operator= (Block_pool&&) = delete;
+
+private:
+  struct Free_block {
+    Free_block* next;
+  };
+  std::size_t block_size;
+  Free_block* free_list;
+  std::vector<std::unique_ptr<char[]>> chunks;
+  std::size_t carved; // the blocks carved so far out of the last chunk
+};
+
+template <typename T>
+class Pool_allocator {
+public:
+  using value_type = T;
+
+  Pool_allocator() = default;
+  template <typename U>
+  Pool_allocator(const Pool_allocator<U>&) {}
+
+  // single objects come from the pool of T; arrays from the heap
+  T* allocate(std::size_t n)
+    {return static_cast<T*>(n == 1 ? get_pool().allocate() : ::operator new(n * sizeof(T)));}
+  void deallocate(T* p, std::size_t n)
+    {if (n == 1) get_pool().deallocate(p); else ::operator delete(p);}
+
+private:
+  // one pool per type, made when first needed and kept to the end
+  static Block_pool& get_pool()
+    {static Block_pool* pool = new Block_pool(sizeof(T)); return *pool;}
+};
+
+// every Pool_allocator draws on the same pools, so any can free what another allocated
+template <typename T, typename U>
+bool operator== (const Pool_allocator<T>&, const Pool_allocator<U>&) {return true;}
+template <typename T, typename U>
+bool operator!= (const Pool_allocator<T>&, const Pool_allocator<U>&) {return false;}
+
+#endif
@@ -2,21 +2,27 @@
 #include "Island.h"
 #include "Utility.h"
 #include "Model.h"
+#include "Island_registry.h"
 #include <iostream>
 using std::cout;
 using std::endl;
 using std::shared_ptr;
 
-// initialize, then output constructor message
-Ship::Ship(const std::string& name_, Point position_, double fuel_capacity_,
-  double maximum_speed_, double fuel_consumption_, int resistance_)
-  :Sim_object(name_), fuel(fuel_capacity_),
-  fuel_consumption(fuel_consumption_), fuel_capacity(fuel_capacity_), 
-  maximum_speed(maximum_speed_), resistance(resistance_), ship_state(State::STOPPED),
-  docked_Island(nullptr)
+// initialize from the parameters of the type, then output constructor message
+Ship::Ship(const std::string& name_, Point position_, int type_id_, unsigned capabilities_)
+  :Sim_object(name_), fuel(Ship_types::get(type_id_).fuel_capacity),
+  type_id(type_id_), resistance(Ship_types::get(type_id_).resistance), capabilities(capabilities_),
+  watched_events(0), ship_state(State::STOPPED),
+  docked_Island(nullptr), berth(0)
 {
   track_base.set_position(position_); // NOTE: CAN INIT W/ CONSTUCTOR
 }
+
+// a ship still docked leaves its berth
+Ship::~Ship()
+{
+  leave_berth();
+}
   
 // Return true if ship can move (it is not dead in the water or in the process or sinking);
 bool Ship::can_move() const
@@ -42,9 +48,23 @@ bool Ship::is_afloat() const
   return !(ship_state == State::SUNK);
 }
 
+// return the name of the current state, for measurements
+const char* Ship::get_state_name() const
+{
+  switch (ship_state) {
+    case State::DOCKED: return "docked";
+    case State::STOPPED: return "stopped";
+    case State::MOVING_TO_POSITION: return "moving to position";
+    case State::MOVING_ON_COURSE: return "moving on course";
+    case State::DEAD_IN_THE_WATER: return "dead in the water";
+    case State::SUNK: return "sunk";
+  }
+  return "unknown";
+}
+
 // Return true if the ship is Stopped and the distance to the supplied island
 // is less than or equal to 0.1 nm
-bool Ship::can_dock(shared_ptr<Island> island_ptr) const
+bool Ship::can_dock(const shared_ptr<Island>& island_ptr) const
 {
   return (ship_state == State::STOPPED && 
     cartesian_distance(get_location(), island_ptr->get_location()) <= 0.1); //NOTE: CONST FOR 0.1
@@ -114,23 +134,21 @@ void Ship::describe() const
 void Ship::broadcast_current_state()
 {
   Model::get_Instance().notify_location(get_name(), get_location());
-  Model::get_Instance().notify_ship_fuel(get_name(), fuel);
-  Model::get_Instance().notify_ship_course(get_name(), track_base.get_course());
-  Model::get_Instance().notify_ship_speed(get_name(), track_base.get_speed());
+  Model::get_Instance().notify_ship_fuel(get_name(), get_fuel());
+  Model::get_Instance().notify_ship_course(get_name(), get_course());
+  Model::get_Instance().notify_ship_speed(get_name(), get_speed());
 }
 
 // Start moving to a destination position at a speed
 void Ship::set_destination_position_and_speed(Point destination_position, double speed) // NOTE: DUPLICATE W/ NEXT FUNC
 {
   if (can_move()) {
-    if (speed <= maximum_speed) {
+    if (speed <= get_type().maximum_speed) {
       destination = destination_position;
       Compass_vector cv(get_location(), destination);
       track_base.set_course(cv.direction);
       track_base.set_speed(speed);
-      if (ship_state == State::DOCKED) {
-        docked_Island = nullptr;
-      }
+      leave_berth();
       ship_state = State::MOVING_TO_POSITION;
       cout << get_name() << " will sail on " << track_base.get_course_speed() 
         << " to " << destination << endl;
@@ -147,12 +165,10 @@ void Ship::set_destination_position_and_speed(Point destination_position, double
 void Ship::set_course_and_speed(double course, double speed)
 {
   if (can_move()) {
-    if (speed <= maximum_speed) {
+    if (speed <= get_type().maximum_speed) {
       track_base.set_course(course);
       track_base.set_speed(speed);
-      if (ship_state == State::DOCKED) {
-        docked_Island = nullptr;
-      }
+      leave_berth();
       ship_state = State::MOVING_ON_COURSE; 
       cout << get_name() << " will sail on " << track_base.get_course_speed() << endl;
       broadcast_current_state();
@@ -169,6 +185,7 @@ void Ship::stop()
 {
   if (can_move()) {
     track_base.set_speed(0.);
+    leave_berth();
     ship_state = State::STOPPED;
     cout << get_name() << " stopping at " << get_location() << endl; 
     broadcast_current_state();
@@ -178,14 +195,16 @@ void Ship::stop()
 }
 
 // dock at an Island - set our position = Island's position, go into Docked state
-void Ship::dock(shared_ptr<Island> island_ptr)
+void Ship::dock(const shared_ptr<Island>& island_ptr)
 {
   if (can_dock(island_ptr)) { //NOTE: BETTER BE FLAT: HANDLE ERROR CASE IN THE INDENT
     track_base.set_position(island_ptr->get_location());
     ship_state = State::DOCKED;
     cout << get_name() << " docked at " << island_ptr-> get_name() << endl;
-    docked_Island = island_ptr;
+    docked_Island = island_ptr.get();
+    berth = island_ptr->add_berth(this);
     broadcast_current_state();
+    signal_event(DOCKS);
   } else {
     throw Error("Can't dock!");
   }
@@ -195,11 +214,17 @@ void Ship::dock(shared_ptr<Island> island_ptr)
 void Ship::refuel()
 {
   if (is_docked()) {
-    double need = fuel_capacity - fuel;
-    if (need < 0.005) fuel = fuel_capacity; 
+    double need = get_type().fuel_capacity - fuel;
+    if (need < 0.005) fuel = get_type().fuel_capacity; 
     else {
-      fuel += docked_Island->provide_fuel(need);
-      cout << get_name() << " now has " << fuel << " tons of fuel" << endl;
+      // the island may meet the request only when it settles the tick's requests,
+      // and only while this ship is still present
+      docked_Island->request_fuel(need, handle, [this](double amount) {
+        fuel += amount;
+        cout << get_name() << " now has " << fuel << " tons of fuel" << endl;
+        broadcast_current_state();
+      });
+      return;
     }
     broadcast_current_state();
   } else {
@@ -220,7 +245,7 @@ void Ship::set_unload_destination(shared_ptr<Island>)
 }
 
 // Fat interface command function - will throw error
-void Ship::attack(shared_ptr<Ship> in_target_ptr)
+void Ship::attack(Ship&)
 {
   throw Error("Cannot attack!");
 }
@@ -231,19 +256,32 @@ void Ship::stop_attack()
   throw Error("Cannot attack!");
 }
 
+// Fat interface command function - will throw error
+void Ship::set_itinerary(Itinerary)
+{
+  throw Error("Cannot cruise!");
+}
+
+// Fat interface command function - will throw error
+void Ship::patrol(Point, double, double)
+{
+  throw Error("Cannot attack!");
+}
+
 // receive a hit from an attacker
-// why attacker_ptr here?
+// why attacker here?
 // this is a partial fat interface for warship, so that warship can attack back
-void Ship::receive_hit(int hit_force, shared_ptr<Ship> attacker_ptr) 
+void Ship::receive_hit(int hit_force, Ship&)
 {
   resistance -= hit_force;
   cout << get_name() << " hit with " << hit_force << ", resistance now " << resistance << endl;
   if (resistance < 0) {
     cout << get_name() << " sunk" << endl;
+    leave_berth();
     ship_state = State::SUNK;
     track_base.set_speed(0.);
     broadcast_current_state(); //NOTE: POSSIBILY NOT NECESSARY
-    Model::get_Instance().notify_gone(get_name());
+    signal_event(SINKS);
     Model::get_Instance().remove_ship(shared_from_this());
   }
 }
@@ -251,16 +289,22 @@ void Ship::receive_hit(int hit_force, shared_ptr<Ship> attacker_ptr)
 // protected member function
 double Ship:: get_maximum_speed() const
 {
-  return maximum_speed;
+  return get_type().maximum_speed;
 }
 
 // protected member function
-shared_ptr<Island> Ship::get_docked_Island() const
+Island* Ship::get_docked_Island() const
 {
   if (ship_state == State::DOCKED) return docked_Island;
   else return nullptr;
 }
 
+// protected member function
+const shared_ptr<Island>& Ship::get_island(int index)
+{
+  return Model::get_Instance().get_island_registry()[index];
+}
+
 /* Private Function Definitions */
 
 /*
@@ -283,6 +327,7 @@ void Ship:: calculate_movement()
   // Compute values for how much we need to move, and how much we can, and how long we can,
   // given the fuel state, then decide what to do.
   double time = 1.0;  // "full step" time
+  double fuel_consumption = get_type().fuel_consumption;  // tons/nm required
   // get the distance to destination
   double destination_distance = cartesian_distance(get_location(), destination);
   // get full step distance we can move on this time step
@@ -308,6 +353,7 @@ void Ship:: calculate_movement()
     fuel -= fuel_required;
     track_base.set_speed(0.);
     ship_state = State::STOPPED;
+    signal_event(ARRIVES);
   } else {
     // go as far as we can, stay in the same movement state
     // simply move for the amount of time possible
@@ -317,8 +363,24 @@ void Ship:: calculate_movement()
       fuel = 0.0;
       track_base.set_speed(0.);
       ship_state = State::DEAD_IN_THE_WATER;
+      signal_event(RUNS_DRY);
     } else {
       fuel -= full_fuel_required;
     }
   }
 }
+
+// tell the Model the watched event has happened
+void Ship::notify_event(Event event)
+{
+  Model::get_Instance().notify_event(get_name(), event);
+}
+
+// if docked, leave the berth at the island
+void Ship::leave_berth()
+{
+  if (ship_state != State::DOCKED) return;
+  Ship* moved = docked_Island->remove_berth(berth);
+  if (moved) moved->berth = berth;
+  docked_Island = nullptr;
+}
@@ -1,5 +1,6 @@
 /***** Ship Class *****/
 /* A Ship has a name, initial position, amount of fuel, and parameters that govern its movement.
+The parameters are those of its type in the Ship_types table, which the Ship refers to by ID.
 The initial amount of fuel is equal to the supplied fuel capacity - a full fuel tank.
 A Ship can be commanded to move to either a position or follow a course, or stop,
 dock at or refuel at an Island. It consumes fuel while moving, and becomes immobile
@@ -11,7 +12,9 @@ The update function updates the position and/or state of the ship.
 The describe function outputs information about the ship state.
 Accessors make the ship state available to either the public or to derived classes.
 The is a "fat interface" for the capabilities of derived types of Ships. These
-functions are implemented in this class to throw an Error exception.
+functions are implemented in this class to throw an Error exception. Each type
+also states its capabilities as a bitmask, so a caller can check one before using
+the fat interface instead of catching the Error.
 */
 
 #ifndef SHIP_H
@@ -19,15 +22,30 @@ functions are implemented in this class to throw an Error exception.
 #include "Sim_object.h"
 #include "Track_base.h"
 #include "Geometry.h"
+#include "Ship_handle.h"
+#include "Ship_types.h"
 #include <memory>
 
 class Island;
 
 class Ship : public Sim_object, public std::enable_shared_from_this<Ship> {
 public:
+  // the capabilities beyond those of every Ship, one bit each
+  enum Capability : unsigned {CAN_LOAD = 1, CAN_UNLOAD = 2, CAN_ATTACK = 4, CAN_CRUISE = 8};
+  // the order a cruise visits the islands in
+  enum class Itinerary {GREEDY, OPTIMIZED};
+  // the state transitions a trigger can wait for, one bit each
+  enum Event : unsigned {ARRIVES = 1, DOCKS = 2, RUNS_DRY = 4, SINKS = 8, LOADED = 16};
+
   /*** Readers ***/
   // return the current position
   Point get_location() const override {return track_base.get_position();}
+  // the name of the ship's type in the Ship_types table
+  const std::string& get_type_name() const override {return Ship_types::get(type_id).name;}
+  // return the current fuel, course and speed
+  double get_fuel() const {return fuel;}
+  double get_course() const {return track_base.get_course();}
+  double get_speed() const {return track_base.get_speed();}
   
   // Return true if ship can move (it is not dead in the water or in the process or sinking); 
   bool can_move() const;
@@ -38,12 +56,29 @@ public:
   // Return true if ship is docked; 
   bool is_docked() const;
   
+  // Return true if the fat interface functions of the capability are supported
+  bool has_capability(unsigned capability) const {return (capabilities & capability) == capability;}
+
   // Return true if ship is afloat (not in process of sinking), false if not
   bool is_afloat() const;
+
+  // Return true if the ship is patrolling an area
+  virtual bool is_patrolling() const {return false;}
+
+  // return the name of the current state, for measurements
+  const char* get_state_name() const;
+
+  // the handle the Model issued when the ship was added
+  Ship_handle get_handle() const {return handle;}
+  void set_handle(Ship_handle handle_) {handle = handle_;}
+
+  // the events the Model has triggers waiting for; only these are signaled to it
+  unsigned get_watched_events() const {return watched_events;}
+  void set_watched_events(unsigned events) {watched_events = events;}
   
   // Return true if the ship is Stopped and the distance to the supplied island
   // is less than or equal to 0.1 nm
-  bool can_dock(std::shared_ptr<Island> island_ptr) const;
+  bool can_dock(const std::shared_ptr<Island>& island_ptr) const;
   
   /*** Interface to derived classes ***/
   // Update the state of the Ship
@@ -67,7 +102,7 @@ public:
   virtual void stop();
   // dock at an Island - set our position = Island's position, go into Docked state
      // may throw Error("Can't dock!");
-  virtual void dock(std::shared_ptr<Island> island_ptr);
+  virtual void dock(const std::shared_ptr<Island>& island_ptr);
   // Refuel - must already be docked at an island; fill takes as much as possible
      // may throw Error("Must be docked!");
   virtual void refuel();
@@ -79,14 +114,21 @@ public:
     // will always throw Error("Cannot unload at a destination!");
   virtual void set_unload_destination(std::shared_ptr<Island>);
     // will always throw Error("Cannot attack!");
-  virtual void attack(std::shared_ptr<Ship> in_target_ptr);
+  virtual void attack(Ship& target);
     // will always throw Error("Cannot attack!");
   virtual void stop_attack();
+    // will always throw Error("Cannot cruise!");
+  virtual void set_itinerary(Itinerary);
+    // will always throw Error("Cannot attack!");
+  virtual void patrol(Point center, double radius, double speed);
 
   // interactions with other objects
   // receive a hit from an attacker
-  virtual void receive_hit(int hit_force, std::shared_ptr<Ship> attacker_ptr);
+  virtual void receive_hit(int hit_force, Ship& attacker);
     
+  // a ship still docked leaves its berth
+  ~Ship();
+
   // disallow copy/move, construction or assignment
   Ship(const Ship&) = delete;
   Ship(Ship&&) = delete;
@@ -94,30 +136,42 @@ public:
   Ship& operator= (Ship&&) = delete;
 
 protected:
-  // initialize, then output constructor message
-  Ship(const std::string& name_, Point position_, double fuel_capacity_, 
-    double maximum_speed_, double fuel_consumption_, int resistance_);
+  // initialize from the parameters of the type, then output constructor message
+  Ship(const std::string& name_, Point position_, int type_id_, unsigned capabilities_ = 0);
     
   double get_maximum_speed() const;
+  // the fixed parameters of the ship's type
+  const Ship_type& get_type() const {return Ship_types::get(type_id);}
+  // tell the Model the event has happened, if a trigger is waiting for it
+  void signal_event(Event event)
+    {if (watched_events & event) notify_event(event);}
   // return pointer to the Island currently docked at, or nullptr if not docked
-  std::shared_ptr<Island> get_docked_Island() const;
+  Island* get_docked_Island() const;
+  // the island of the index in the Model's island registry
+  static const std::shared_ptr<Island>& get_island(int index);
 
 private:
   Track_base track_base;
   double fuel;            // Current amount of fuel
-  double fuel_consumption;      // tons/nm required
   Point destination;          // Current destination if any
 
-  double fuel_capacity; //maximum amout of fuel
-  double maximum_speed; //maximum speed of the ship
+  int type_id; // the ship's type in the Ship_types table, which has its fuel capacity, speed and consumption
   int resistance; // current resistance of the ship, if < 0, starts sinking
+  unsigned capabilities; // bitmask of Capability
+  unsigned watched_events; // bitmask of Event
+  Ship_handle handle;
 
   enum class State {DOCKED, STOPPED, MOVING_TO_POSITION, MOVING_ON_COURSE, DEAD_IN_THE_WATER, SUNK};
   State ship_state;  //state of the ship
-  std::shared_ptr<Island> docked_Island; // island that the ship is docked at, nullptr if none
+  Island* docked_Island; // island that the ship is docked at, nullptr if none; islands outlive ships
+  int berth; // the index of the ship in the docked island's registry
 
   // Updates position, fuel, and movement_state, assuming 1 time unit (1 hr)
   void calculate_movement();
+  // tell the Model the watched event has happened
+  void notify_event(Event event);
+  // if docked, leave the berth at the island
+  void leave_berth();
 
 };
 #endif
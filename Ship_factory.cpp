@@ -2,24 +2,27 @@
 #include "Tanker.h"
 #include "Cruiser.h"
 #include "Cruise_ship.h"
+#include "Pool_allocator.h"
+#include "Ship_types.h"
 #include "Utility.h"
 
 /* This is a very simple form of factory, a function; you supply the information, it creates
-the specified kind of object and returns a pointer to it. The Ship is allocated
-with new, so some other component is resposible for deleting it.
+the specified kind of object and returns a pointer to it. The Ship and its shared_ptr
+control block are allocated together from the pool for its type, and go back to it
+when the last pointer to the Ship is gone.
 */
 std::shared_ptr<Ship> create_ship(const std::string& name, const std::string& type, Point initial_position)
 {
-  if (type == "Tanker") {
-    std::shared_ptr<Tanker> p(new Tanker(name, initial_position));
-    return p;
-  } else if (type == "Cruiser") {
-    std::shared_ptr<Cruiser> p(new Cruiser(name, initial_position));
-    return p;
-  } else if (type == "Cruise_ship") {
-    std::shared_ptr<Cruise_ship> p(new Cruise_ship(name, initial_position));
-    return p;
-  } else {
+  int type_id = Ship_types::find(type);
+  if (type_id == Ship_types::NO_TYPE)
     throw Error("Trying to create ship of unknown type!");
+  switch (Ship_types::get(type_id).kind) {
+    case Ship_kind::TANKER:
+      return std::allocate_shared<Tanker>(Pool_allocator<Tanker>(), name, initial_position, type_id);
+    case Ship_kind::CRUISER:
+      return std::allocate_shared<Cruiser>(Pool_allocator<Cruiser>(), name, initial_position, type_id);
+    case Ship_kind::CRUISE:
+      return std::allocate_shared<Cruise_ship>(Pool_allocator<Cruise_ship>(), name, initial_position, type_id);
   }
+  throw Error("Trying to create ship of unknown type!");
 }
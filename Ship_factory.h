@@ -7,8 +7,10 @@ struct Point;
 
 class Ship;
 /* This is a very simple form of factory, a function; you supply the information, it creates
-the specified kind of object and returns a pointer to it. The Ship is allocated
-with new, so some other component is resposible for deleting it.
+the specified kind of object and returns a pointer to it. The type is looked up in the
+Ship_types table, whose entry says which class of Ship to create. The Ship and its shared_ptr
+control block are allocated together from the pool for its class, and go back to it
+when the last pointer to the Ship is gone.
 */
 
 // may throw Error("Trying to create ship of unknown type!")
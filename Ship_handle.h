@@ -0,0 +1,17 @@
+/* Ship_handle
+A Ship_handle names a ship by its slot in the Model's table of ships, and by the
+slot's generation when the ship was added. It takes the place of a weak_ptr to a
+ship: checking it is one comparison, with no reference count to update, and it
+stays valid to hold after the ship is gone. See Model::get_ship.
+*/
+#ifndef SHIP_HANDLE_H
+#define SHIP_HANDLE_H
+
+struct Ship_handle {
+  unsigned slot;
+  unsigned generation;
+  Ship_handle(unsigned slot_ = 0, unsigned generation_ = 0)
+    :slot(slot_), generation(generation_) {}
+};
+
+#endif
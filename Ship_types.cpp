@@ -0,0 +1,60 @@
+#include "Ship_types.h"
+#include "Utility.h"
+#include <fstream>
+#include <sstream>
+using std::string;
+
+// the built-in types
+std::vector<Ship_type> Ship_types::types = {
+  {"Tanker", Ship_kind::TANKER, 100., 10., 2., 0, 0, 0., 1000.},
+  {"Cruiser", Ship_kind::CRUISER, 1000., 20., 10., 6, 3, 15., 0.},
+  {"Cruise_ship", Ship_kind::CRUISE, 500., 15., 2., 0, 0, 0., 0.}
+};
+
+// the ID of the type of that name, or NO_TYPE if none
+int Ship_types::find(const string& name)
+{
+  for (int id = 0; id < int(types.size()); ++id) {
+    if (types[id].name == name) return id;
+  }
+  return NO_TYPE;
+}
+
+// add the types in the file, replacing any of the same name
+void Ship_types::load(const string& filename)
+{
+  std::ifstream file(filename);
+  if (!file)
+    throw Error("Cannot open ship types file!");
+  string line;
+  while (std::getline(file, line)) {
+    std::istringstream fields(line.substr(0, line.find('#')));
+    Ship_type type {"", Ship_kind::TANKER, 0., 0., 0., 0, 0, 0., 0.};
+    string kind;
+    if (!(fields >> type.name)) continue;
+    if (!(fields >> kind >> type.fuel_capacity >> type.maximum_speed >> type.fuel_consumption >> type.resistance))
+      throw Error("Invalid ship type!");
+    bool valid;
+    if (kind == "Tanker") {
+      type.kind = Ship_kind::TANKER;
+      valid = bool(fields >> type.cargo_capacity) && type.cargo_capacity > 0.;
+    } else if (kind == "Cruiser") {
+      type.kind = Ship_kind::CRUISER;
+      valid = bool(fields >> type.firepower >> type.maximum_range) && type.firepower > 0 && type.maximum_range > 0.;
+    } else if (kind == "Cruise_ship") {
+      type.kind = Ship_kind::CRUISE;
+      valid = true;
+    } else {
+      valid = false;
+    }
+    string extra;
+    if (!valid || fields >> extra || type.fuel_capacity <= 0. || type.maximum_speed <= 0.
+        || type.fuel_consumption <= 0. || type.resistance < 0)
+      throw Error("Invalid ship type!");
+    int id = find(type.name);
+    if (id == NO_TYPE)
+      types.push_back(type);
+    else
+      types[id] = type;
+  }
+}
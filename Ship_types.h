@@ -0,0 +1,55 @@
+/* Ship_types
+Ship_types is the table of the kinds of ship that can be created, and the
+parameters of each: fuel capacity, maximum speed, fuel consumption and resistance,
+and for the kinds that have them, firepower, attacking range and cargo capacity.
+A Ship keeps only the index of its type in the table, its type ID, and reads its
+fixed parameters from there.
+
+The table starts with the built-in Tanker, Cruiser and Cruise_ship. A ship type
+file read at startup may change their parameters or add variants of them, such as
+a fast tanker or a heavy cruiser, each behaving as the kind it names. The file has
+one type per line, with "#" starting a comment:
+  <name> Tanker <fuel capacity> <maximum speed> <fuel consumption> <resistance> <cargo capacity>
+  <name> Cruiser <fuel capacity> <maximum speed> <fuel consumption> <resistance> <firepower> <range>
+  <name> Cruise_ship <fuel capacity> <maximum speed> <fuel consumption> <resistance>
+The table must be complete before the first ship is created, and does not change
+afterward, so references to its entries stay valid.
+*/
+#ifndef SHIP_TYPES_H
+#define SHIP_TYPES_H
+#include <string>
+#include <vector>
+
+// the class that implements a ship type's behavior
+enum class Ship_kind {TANKER, CRUISER, CRUISE};
+
+struct Ship_type {
+  std::string name;
+  Ship_kind kind;
+  double fuel_capacity;
+  double maximum_speed;
+  double fuel_consumption; // tons/nm
+  int resistance;
+  int firepower;          // CRUISER only
+  double maximum_range;   // CRUISER only
+  double cargo_capacity;  // TANKER only
+};
+
+class Ship_types {
+public:
+  static const int NO_TYPE = -1;
+
+  // the type of the ID
+  static const Ship_type& get(int id) {return types[id];}
+  // the ID of the type of that name, or NO_TYPE if none
+  static int find(const std::string& name);
+  // add the types in the file, replacing any of the same name
+  // may throw Error("Cannot open ship types file!")
+  // may throw Error("Invalid ship type!")
+  static void load(const std::string& filename);
+
+private:
+  static std::vector<Ship_type> types;
+};
+
+#endif
@@ -2,7 +2,7 @@
 
 // output the constructor message with object's name
 Sim_object::Sim_object(const std::string& name_)
-  :name(name_)
+  :name(name_), removed(false)
 {}
 
 Sim_object::~Sim_object()//NOTE: BETTER DEFINE DIRECLY IN THE .H FILE
@@ -20,13 +20,22 @@ public:
   // ask model to notify views of current state
   virtual void broadcast_current_state() {}
 
+  // a removed object is marked, and skipped, until the Model takes it out of its containers
+  bool is_removed() const
+    {return removed;}
+  void mark_removed()
+    {removed = true;}
+
   /* Interface for derived classes */
+  // the name of the object's concrete type, e.g. "Island" or "Tanker"
+  virtual const std::string& get_type_name() const = 0;
   virtual Point get_location() const = 0;
   virtual void describe() const = 0;
   virtual void update() = 0;
   
 private:
   std::string name; //sim_object name
+  bool removed;
 };
 
 
@@ -0,0 +1,89 @@
+#include "Spatial_grid.h"
+#include "Ship.h"
+#include <cmath>
+using std::string;
+using std::vector;
+
+// the side of a cell in nm, about the longest attacking range, so that a query
+// of a range up to it looks at no more than nine cells
+static const double CELL_SIZE = 16.;
+
+// index the ship at its current location
+void Spatial_grid::insert(Ship* ship)
+{
+  long long cell = cell_of(ship->get_location());
+  vector<Ship*>& listed = cells[cell];
+  entries[ship->get_name()] = Entry{cell, listed.size()};
+  listed.push_back(ship);
+}
+
+// forget the ship, if indexed
+void Spatial_grid::remove(const string& name)
+{
+  auto it = entries.find(name);
+  if (it == entries.end()) return;
+  Entry entry = it->second;
+  entries.erase(it);
+  unlist(entry);
+}
+
+// the ship of that name, if indexed, is now at the location
+void Spatial_grid::move(const string& name, Point location)
+{
+  auto it = entries.find(name);
+  if (it == entries.end()) return;
+  long long cell = cell_of(location);
+  if (cell == it->second.cell) return;
+  Entry old_entry = it->second;
+  Ship* ship = cells[old_entry.cell][old_entry.index];
+  vector<Ship*>& listed = cells[cell];
+  it->second = Entry{cell, listed.size()};
+  listed.push_back(ship);
+  unlist(old_entry);
+}
+
+// the nearest ship to the point within the range for which accept is true, the
+// first in name order if there are several; nullptr if none
+Ship* Spatial_grid::find_nearest(Point point, double range,
+  const std::function<bool(const Ship&)>& accept) const
+{
+  Ship* nearest = nullptr;
+  double nearest_distance = range;
+  long long first_column = (long long)std::floor((point.x - range) / CELL_SIZE);
+  long long last_column = (long long)std::floor((point.x + range) / CELL_SIZE);
+  long long first_row = (long long)std::floor((point.y - range) / CELL_SIZE);
+  long long last_row = (long long)std::floor((point.y + range) / CELL_SIZE);
+  for (long long column = first_column; column <= last_column; ++column) {
+    for (long long row = first_row; row <= last_row; ++row) {
+      auto cell = cells.find(cell_key(column, row));
+      if (cell == cells.end()) continue;
+      for (Ship* ship : cell->second) {
+        double distance = cartesian_distance(point, ship->get_location());
+        if (distance > nearest_distance) continue;
+        if (nearest && distance == nearest_distance && ship->get_name() > nearest->get_name()) continue;
+        if (!accept(*ship)) continue;
+        nearest = ship;
+        nearest_distance = distance;
+      }
+    }
+  }
+  return nearest;
+}
+
+long long Spatial_grid::cell_of(Point location)
+{
+  return cell_key((long long)std::floor(location.x / CELL_SIZE), (long long)std::floor(location.y / CELL_SIZE));
+}
+
+// take the ship out of the list of its cell, keeping the moved ship's entry current
+void Spatial_grid::unlist(const Entry& entry)
+{
+  auto cell = cells.find(entry.cell);
+  vector<Ship*>& listed = cell->second;
+  if (entry.index + 1 != listed.size()) {
+    listed[entry.index] = listed.back();
+    entries[listed[entry.index]->get_name()].index = entry.index;
+  }
+  listed.pop_back();
+  if (listed.empty()) cells.erase(cell);
+}
@@ -0,0 +1,58 @@
+/* Spatial_grid
+The Spatial_grid indexes the ships by location, so that the ships near a point are
+found without looking at every ship. The sea is divided into square cells of
+CELL_SIZE nm, and each cell lists the ships in it. A query looks only at the cells
+that overlap the square around the point of twice the range on a side.
+
+A ship is moved to another cell only when it crosses into it, which costs one
+lookup by name per move; within a cell nothing changes. The grid does not own the
+ships: whoever inserts a ship removes it before the ship is destroyed.
+*/
+#ifndef SPATIAL_GRID_H
+#define SPATIAL_GRID_H
+#include "Geometry.h"
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <functional>
+
+class Ship;
+
+class Spatial_grid {
+public:
+  Spatial_grid() = default;
+
+  // index the ship at its current location
+  void insert(Ship* ship);
+  // forget the ship, if indexed
+  void remove(const std::string& name);
+  // the ship of that name, if indexed, is now at the location
+  void move(const std::string& name, Point location);
+
+  // the nearest ship to the point within the range for which accept is true, the
+  // first in name order if there are several; nullptr if none
+  Ship* find_nearest(Point point, double range, const std::function<bool(const Ship&)>& accept) const;
+
+  // disallow copy/move construction or assignment
+  Spatial_grid(const Spatial_grid&) = delete;
+  Spatial_grid(Spatial_grid&&) = delete;
+  Spatial_grid& operator= (const Spatial_grid&) = delete;
+  Spatial_grid& operator= (Spatial_grid&&) = delete;
+
+private:
+  // where a ship is listed: its cell and its place in the cell's list
+  struct Entry {
+    long long cell;
+    std::size_t index;
+  };
+  std::unordered_map<std::string, Entry> entries; // by ship name
+  std::unordered_map<long long, std::vector<Ship*>> cells; // by cell key
+
+  static long long cell_key(long long column, long long row)
+    {return (long long)(((unsigned long long)column << 32) ^ ((unsigned long long)row & 0xffffffffULL));}
+  static long long cell_of(Point location);
+  // take the ship out of the list of its cell, keeping the moved ship's entry current
+  void unlist(const Entry& entry);
+};
+
+#endif
@@ -1,24 +1,21 @@
 #include "Tanker.h"
 #include "Island.h"
+#include "Island_registry.h"
+#include "Model.h"
 #include "Utility.h"
 #include <iostream>
 using std::cout;
 using std::endl;
 using std::shared_ptr;
 
-const double Tanker::FUEL_CAPACITY = 100.0;
-const double Tanker::MAX_SPEED = 10.0;
-const double Tanker::FUEL_CONSUMPTION = 2.0;
-const int Tanker::RESISTANCE = 0;
-const double Tanker::CARGO_CAPACITY = 1000.0;
 const double Tanker::INIT_CARGO = 0.0;
 
 // initialize, the output constructor message
-Tanker::Tanker(const std::string& name_, Point position_)
-  :Ship(name_, position_, FUEL_CAPACITY, MAX_SPEED, FUEL_CONSUMPTION, RESISTANCE),
-  cargo(INIT_CARGO), cargo_capacity(CARGO_CAPACITY),
+Tanker::Tanker(const std::string& name_, Point position_, int type_id_)
+  :Ship(name_, position_, type_id_, CAN_LOAD | CAN_UNLOAD),
+  cargo(INIT_CARGO),
   tanker_state(State::NO_CARGO_DESTINATIONS),
-  load_destination(nullptr), unload_destination(nullptr) //NOTE: EXPLICIT INIT NOT NECESSARY
+  load_destination(Island_registry::NO_ISLAND), unload_destination(Island_registry::NO_ISLAND)
 {}
 
 // check if this Tanker has assigned cargo destinations, if yes, throw error
@@ -48,7 +45,7 @@ void Tanker::set_course_and_speed(double course, double speed)
 void Tanker::set_load_destination(shared_ptr<Island> island_ptr)
 {
   if (tanker_state == State::NO_CARGO_DESTINATIONS) {
-    load_destination = island_ptr;
+    load_destination = Model::get_Instance().get_island_registry().index_of(*island_ptr);
     if (load_destination == unload_destination) {
       throw Error("Load and unload cargo destinations are the same!");
     }
@@ -63,7 +60,7 @@ void Tanker::set_load_destination(shared_ptr<Island> island_ptr)
 void Tanker::set_unload_destination(shared_ptr<Island> island_ptr)
 {
   if (tanker_state == State::NO_CARGO_DESTINATIONS) {
-    unload_destination = island_ptr;
+    unload_destination = Model::get_Instance().get_island_registry().index_of(*island_ptr);
     if (unload_destination == load_destination) {
       throw Error("Load and unload cargo destinations are the same!");
     }
@@ -74,6 +71,18 @@ void Tanker::set_unload_destination(shared_ptr<Island> island_ptr)
   }
 }
 
+// replace the cargo destinations and start the cycle again from wherever the Tanker is
+void Tanker::set_cargo_destinations(int load, int unload)
+{
+  if (load == load_destination && unload == unload_destination) return;
+  load_destination = load;
+  unload_destination = unload;
+  tanker_state = State::NO_CARGO_DESTINATIONS;
+  cout << get_name() << " will load at " << get_island(load)->get_name()
+    << " and unload at " << get_island(unload)->get_name() << endl;
+  start_cycle_if_appropriate();
+}
+
 // when told to stop, clear the cargo destinations and stop
 void Tanker::stop()
 {
@@ -90,38 +99,41 @@ void Tanker::update()
   } else {
     switch (tanker_state) {
       case State::MOVING_TO_LOADING:
-        if (!is_moving() && can_dock(load_destination)) {
-          dock(load_destination);
+        if (!is_moving() && can_dock(get_island(load_destination))) {
+          dock(get_island(load_destination));
           tanker_state = State::LOADING;
         }
         break;
       case State::MOVING_TO_UNLOADING:
-        if (!is_moving() && can_dock(unload_destination)) {
-          dock(unload_destination);
+        if (!is_moving() && can_dock(get_island(unload_destination))) {
+          dock(get_island(unload_destination));
           tanker_state = State::UNLOADING;
         }
         break;
       case State::LOADING:
       {
         refuel();
-        double need = cargo_capacity - cargo;
+        double need = get_cargo_capacity() - cargo;
         if (need < 0.005) {
-          cargo = cargo_capacity;
-          Ship::set_destination_position_and_speed(unload_destination->get_location(), MAX_SPEED);
+          cargo = get_cargo_capacity();
+          signal_event(LOADED);
+          Ship::set_destination_position_and_speed(get_island(unload_destination)->get_location(), get_maximum_speed());
           tanker_state = State::MOVING_TO_UNLOADING;
         } else {
-          cargo += load_destination->provide_fuel(need);
-          cout << get_name() << " now has " << cargo << " of cargo" << endl;
+          get_island(load_destination)->request_fuel(need, get_handle(), [this](double amount) {
+            cargo += amount;
+            cout << get_name() << " now has " << cargo << " of cargo" << endl;
+          });
         }
         break;
       }
       case State::UNLOADING:
       {
         if (cargo == 0.0) {
-          Ship::set_destination_position_and_speed(load_destination->get_location(), MAX_SPEED);
+          Ship::set_destination_position_and_speed(get_island(load_destination)->get_location(), get_maximum_speed());
           tanker_state = State::MOVING_TO_LOADING;
         } else {
-          unload_destination->accept_fuel(cargo);
+          get_island(unload_destination)->accept_fuel(cargo);
           cargo = 0.0;
         }
         break;
@@ -135,7 +147,7 @@ void Tanker::update()
 // describe a Tanker
 void Tanker::describe() const
 {
-  cout << "\nTanker ";
+  cout << "\n" << get_type_name() << " ";
   Ship::describe();
   cout << "Cargo: " << cargo << " tons";
   switch (tanker_state) {
@@ -163,34 +175,36 @@ void Tanker::describe() const
 //if yes, start the cycle by finding the appropriate state
 void Tanker::start_cycle_if_appropriate() // NOTE: NEED FLAT OUT, AVOID NESTED IF
 {
-  if (unload_destination && load_destination) {
+  if (unload_destination != Island_registry::NO_ISLAND && load_destination != Island_registry::NO_ISLAND) {
+    const shared_ptr<Island>& load_island = get_island(load_destination);
+    const shared_ptr<Island>& unload_island = get_island(unload_destination);
     if (is_docked()) {
-      if (get_docked_Island() == load_destination) {
+      if (get_docked_Island() == load_island.get()) {
         tanker_state = State::LOADING;
         return;
-      } else if (get_docked_Island() == unload_destination){
+      } else if (get_docked_Island() == unload_island.get()){
         tanker_state = State::UNLOADING;
         return;
       }
     } 
     if (!is_moving()) {
-      if (cargo == 0 && can_dock(load_destination)) {
-        dock(load_destination);
+      if (cargo == 0 && can_dock(load_island)) {
+        dock(load_island);
         tanker_state = State::LOADING;
         return;
-      } else if (cargo > 0 && can_dock(unload_destination)) {
-        dock(unload_destination);
+      } else if (cargo > 0 && can_dock(unload_island)) {
+        dock(unload_island);
         tanker_state = State::UNLOADING;
         return;
       }
     }
     if (cargo == 0) {
       tanker_state = State::MOVING_TO_LOADING;
-      Ship::set_destination_position_and_speed(load_destination->get_location(), MAX_SPEED);
+      Ship::set_destination_position_and_speed(load_island->get_location(), get_maximum_speed());
       return;
     } else if (cargo > 0){
       tanker_state = State::MOVING_TO_UNLOADING;
-      Ship::set_destination_position_and_speed(unload_destination->get_location(), MAX_SPEED);
+      Ship::set_destination_position_and_speed(unload_island->get_location(), get_maximum_speed());
       return;
     }
   } 
@@ -199,8 +213,8 @@ void Tanker::start_cycle_if_appropriate() // NOTE: NEED FLAT OUT, AVOID NESTED I
 // stop the tanker, forget both destinations
 void Tanker::tanker_stop()
 {
-  load_destination = nullptr;
-  unload_destination = nullptr;
+  load_destination = Island_registry::NO_ISLAND;
+  unload_destination = Island_registry::NO_ISLAND;
   tanker_state = State::NO_CARGO_DESTINATIONS;
   cout << get_name() << " now has no cargo destinations" << endl;
 }
@@ -6,9 +6,9 @@ the loading and unloading destination. At the loading destination,
 it will first refuel then wait until its cargo hold is full, then it will
 go to the unloading destination.
 
-Initial values:
+Its parameters come from its type in the Ship_types table; the built-in Tanker has
 fuel capacity and initial amount 100 tons, maximum speed 10., fuel consumption 2.tons/nm, 
-resistance 0, cargo capacity 1000 tons, initial cargo is 0 tons.
+resistance 0, cargo capacity 1000 tons. The initial cargo is 0 tons.
 */
 #ifndef TANKER_H
 #define TANKER_H
@@ -19,7 +19,7 @@ class Island;
 class Tanker : public Ship {
 public:
   // initialize, the output constructor message
-  Tanker(const std::string& name_, Point position_);
+  Tanker(const std::string& name_, Point position_, int type_id_);
   
   // This class overrides these Ship functions so that it can check if this Tanker has assigned cargo destinations.
   // if so, throw an Error("Tanker has cargo destinations!"); otherwise, simply call the Ship functions.
@@ -32,6 +32,22 @@ public:
   // if both destinations are now set, start the cargo cycle
   void set_load_destination(std::shared_ptr<Island>) override;
   void set_unload_destination(std::shared_ptr<Island>) override;
+
+  // Replace the cargo destinations, given by index in the Model's island registry,
+  // which must differ, and start the cycle again
+  // from wherever the Tanker is; cargo on board goes to the new unloading destination.
+  // Nothing changes if the destinations are the ones already set.
+  // may throw Error("Ship cannot move!")
+  void set_cargo_destinations(int load, int unload);
+
+  // the cargo destinations, by index in the Model's island registry; NO_ISLAND if not set
+  int get_load_destination() const {return load_destination;}
+  int get_unload_destination() const {return unload_destination;}
+  // the cargo on board, and the most the hold takes
+  double get_cargo() const {return cargo;}
+  double get_cargo_capacity() const {return get_type().cargo_capacity;}
+  // the speed of the cargo cycle
+  double get_cargo_speed() const {return get_maximum_speed();}
   
   // when told to stop, clear the cargo destinations and stop
   void stop() override;
@@ -43,16 +59,10 @@ private:
   enum class State {NO_CARGO_DESTINATIONS, LOADING, MOVING_TO_UNLOADING, UNLOADING, MOVING_TO_LOADING};
   
   double cargo; //current cargo
-  double cargo_capacity; //maximum amount of cargo
   State tanker_state; // tanker's state
-  std::shared_ptr<Island> load_destination;
-  std::shared_ptr<Island> unload_destination; //load and unload destinations
+  int load_destination;
+  int unload_destination; //load and unload destinations, by index in the island registry
 
-  static const double FUEL_CAPACITY;
-  static const double MAX_SPEED;
-  static const double FUEL_CONSUMPTION;
-  static const int RESISTANCE;
-  static const double CARGO_CAPACITY;
   static const double INIT_CARGO;
 
   //helper
@@ -4,6 +4,12 @@
 View::~View()
 {}
 
+// the notifications this view consumes, by default all of them
+unsigned View::get_interests() const
+{
+  return ALL_INTERESTS;
+}
+
 // update functions
 // If the name is already present,the new info replaces the previous one.
 // update the object's location
@@ -22,6 +28,14 @@ void View::update_ship_course(const std::string& name, double value)
 void View::update_ship_fuel(const std::string& name, double value)
 {}
 
+// the ship's type, sent once before its first location
+void View::update_ship_type(const std::string& name, const std::string& type_name)
+{}
+
 // Remove the name and its location; no error if the name is not present.
 void View::update_remove(const std::string& name)
 {}
+
+// all objects have been updated for the tick ending at time
+void View::update_tick(int time)
+{}
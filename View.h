@@ -31,6 +31,13 @@ class View {
 public:
   virtual ~View();
 
+  // the kinds of notification a View can consume, combined as a bit mask
+  enum Interest {LOCATION = 1, SPEED = 2, COURSE = 4, FUEL = 8, REMOVE = 16, TICK = 32, TYPE = 64,
+    ALL_INTERESTS = LOCATION | SPEED | COURSE | FUEL | REMOVE | TICK | TYPE};
+  // the notifications this view consumes; when the view is attached, Model
+  // subscribes it to these only. Default is all of them.
+  virtual unsigned get_interests() const;
+
   // update functions
   // If the name is already present,the new info replaces the previous one.
   // update the object's location 
@@ -41,9 +48,13 @@ public:
   virtual void update_ship_course(const std::string& name, double value);
   // update ship's fuel
   virtual void update_ship_fuel(const std::string& name, double value);
+  // the ship's type, sent once before its first location
+  virtual void update_ship_type(const std::string& name, const std::string& type_name);
 
   // Remove the name and its location; no error if the name is not present.
   virtual void update_remove(const std::string& name);
+  // all objects have been updated for the tick ending at time
+  virtual void update_tick(int time);
   
   // prints out the current map
   virtual void draw() = 0;
@@ -1,116 +1,119 @@
 #include "Views.h"
 #include "Navigation.h"
 #include "Utility.h"
+#include "Buffered_writer.h"
+#include <cstdio>
+#include <cstring>
+#include <cstdint>
 #include <iostream>
 #include <iomanip>
+#include <sstream>
 #include <string>
 #include <vector>
 #include <cmath>
+#include <algorithm>
+#include <numeric>
 using std::cout;
 using std::endl;
 using std::setw;
 using std::string;
 using std::vector;
 using std::map;
+using std::ostream;
+using std::ostringstream;
 
+// two runs of changed cells closer than this are written as one run,
+// since a cursor sequence costs about as much as the cells it would skip
+static const int LIVE_RUN_GAP = 6;
 
-const int MapView::DEFAULT_SIZE = 25;
-const double MapView::DEFAULT_SCALE = 2.0;
-const Point MapView::DEFAULT_ORIGIN = Point(-10, -10);
-const string MapView::MULTIPLE = "* ";
-const string MapView::EMPTY = ". ";
-
-// default constructor sets the default size, scale, and origin, outputs constructor message
-MapView::MapView()
-  :size(DEFAULT_SIZE), scale(DEFAULT_SCALE), origin(DEFAULT_ORIGIN)
+Live_frame::Live_frame()
+  :top_row(1), height(0), has_frame(false)
 {}
 
-// Save the supplied name and location for future use in a draw() call
-// If the name is already present,the new location replaces the previous one.
-void MapView::update_location(const std::string& name, Point location)
-{
-  auto pair = objects.find(name);
-  if (pair == objects.end()) {
-    objects.insert(std::pair<string, Point>(name, location));
-  } else {
-    pair->second = location;
-  }
-}
-
-// Remove the name and its location; no error if the name is not present.
-void MapView::update_remove(const std::string& name)
+// occupy height rows starting at top_row_, forget the previous frame
+void Live_frame::place(int top_row_, int height_)
 {
-  objects.erase(name);
+  top_row = top_row_;
+  height = height_;
+  has_frame = false;
+  lines.assign(height, string());
 }
 
-// prints out the current map
-void MapView::draw()
+// write text to cout as a delta against the last emitted frame
+void Live_frame::emit(const string& text)
 {
-  cout << "Display size: " << size << ", scale: " << scale << ", origin: " << origin << endl;
-  bool has_outranger = false;
-  vector<vector<string>> arr (size, vector<string>(size, EMPTY));
-  // in alphabetical order
-  for (auto obj : objects) {
-    int ix, iy;
-    if (get_subscripts(ix, iy, obj.second)) {
-      if (arr[ix][iy] != EMPTY){
-        arr[ix][iy] = MULTIPLE; 
-      } else {
-        arr[ix][iy] = obj.first.substr(0,2);
-      }
-    } else {
-      if (has_outranger) {
-        cout << ", ";
-      }
-      cout << obj.first;
-      has_outranger = true;
-    }
+  vector<string> next(height);
+  string::size_type start = 0;
+  for (int row = 0; row < height && start < text.size(); ++row) {
+    string::size_type end = text.find('\n', start);
+    if (end == string::npos) end = text.size();
+    next[row] = text.substr(start, end - start);
+    start = end + 1;
   }
-  if (has_outranger) cout << " outside the map" << endl;
-
-  // output map
-  const char* no_grid = "     "; 
-  int step = 3; // step for printing a grid number
-  int precision = cout.precision();
-  cout.precision(0);
-  int y_grid = (size - 1)-((size - 1) % step);
-  for (int y = size-1; y >= 0; --y) {
-    // output the y-grid
-    if (y == y_grid) {
-      cout << setw(4) <<(y_grid * scale + origin.y)<< " ";
-      y_grid -= step;
-    } else {
-      cout << no_grid;
+  cout << "\0337"; // save cursor
+  for (int row = 0; row < height; ++row) {
+    const string& old_line = lines[row];
+    const string& new_line = next[row];
+    if (!has_frame) {
+      cout << "\033[" << top_row + row << ";1H" << new_line << "\033[K";
+      continue;
     }
-    // output the map for row y
-    for (int x = 0; x < size; ++x) {
-      cout << arr[x][y];
+    if (old_line == new_line) continue;
+    string::size_type common = std::min(old_line.size(), new_line.size());
+    string::size_type col = 0;
+    while (col < new_line.size()) {
+      if (col < common && old_line[col] == new_line[col]) {
+        ++col;
+        continue;
+      }
+      // extend the run over changed cells, absorbing short unchanged gaps
+      string::size_type run_end = col + 1, last_changed = col;
+      while (run_end < new_line.size() && run_end - last_changed <= LIVE_RUN_GAP) {
+        if (run_end >= common || old_line[run_end] != new_line[run_end])
+          last_changed = run_end;
+        ++run_end;
+      }
+      cout << "\033[" << top_row + row << ";" << col + 1 << "H"
+        << new_line.substr(col, last_changed + 1 - col);
+      col = last_changed + 1;
     }
-    cout << endl;
+    if (new_line.size() < old_line.size())
+      cout << "\033[" << top_row + row << ";" << new_line.size() + 1 << "H\033[K";
   }
-  // output the x-grid
-  for (int x_grid=0; x_grid < size; x_grid += step) {
-    cout << setw(6) << (x_grid * scale + origin.x);
-  }
-  cout << endl;
-  //restore
-  cout.precision(precision);
+  cout << "\0338"; // restore cursor
+  cout.flush();
+  lines.swap(next);
+  has_frame = true;
 }
 
-// Discard the saved information
-void MapView::clear()
+
+const int MapView::DEFAULT_SIZE = 25;
+const double MapView::DEFAULT_SCALE = 2.0;
+const Point MapView::DEFAULT_ORIGIN = Point(-10, -10);
+const string MapView::MULTIPLE = "* ";
+const string MapView::EMPTY = ". ";
+const int MapView::MAX_SIZE = 30;
+
+// default constructor sets the default size, scale, and origin, outputs constructor message
+MapView::MapView()
+  :GridView<MapView>(DEFAULT_SIZE, DEFAULT_SIZE, DEFAULT_SCALE, DEFAULT_ORIGIN),
+  has_outranger(false)
+{}
+
+// the notifications this view consumes
+unsigned MapView::get_interests() const
 {
-  objects.clear();
+  return LOCATION | REMOVE;
 }
 
 // modify the display parameters
 void MapView::set_size(int size_)
 {
-  if (size_ > 30)
+  if (size_ > MAX_SIZE)
     throw Error("New map size is too big!");
   if (size_ <= 6)
     throw Error("New map size is too small!");
-  size = size_;
+  set_grid_size(size_, size_);
 }
 
 // modify the display parameters
@@ -118,48 +121,74 @@ void MapView::set_scale(double scale_)
 {
   if (scale_ <= 0.0)
     throw Error("New map scale must be positive!");
-  scale = scale_;
+  set_grid_scale(scale_);
 }
 
 // modify the display parameters
 void MapView::set_origin(Point origin_)
 {
-  origin = origin_;
+  set_grid_origin(origin_);
 }
 
 // set display parameters to map's default
 void MapView::set_defaults()
 {
-  size = DEFAULT_SIZE;
-  scale = DEFAULT_SCALE;
-  origin = DEFAULT_ORIGIN;
+  set_grid_size(DEFAULT_SIZE, DEFAULT_SIZE);
+  set_grid_scale(DEFAULT_SCALE);
+  set_grid_origin(DEFAULT_ORIGIN);
 }
 
-// Calculate the cell subscripts corresponding to the supplied location parameter, 
-// using the current size, scale, and origin of the display. 
-// This function assumes that origin is a  member variable of type Point, 
-// scale is a double value, and size is an integer for the number of rows/columns 
-// currently being used for the grid.
-// Return true if the location is within the grid, false if not
-bool MapView::get_subscripts(int &ix, int &iy, Point location)
-{
-  // adjust with origin and scale
-  Cartesian_vector subscripts = (location - origin) / scale;
-  // truncate coordinates to integer after taking the floor
-  // floor function will produce integer smaller than even for negative values, 
-  // so - 0.05 => -1., which will be outside the array.
-  ix = int(floor(subscripts.delta_x));
-  iy = int(floor(subscripts.delta_y));
-  // if out of range, return false
-  if ((ix < 0) || (ix >= size) || (iy < 0) || (iy >= size)) {
-    return false;
-    }
-  else
-    return true;
+// header, outsiders, the largest map, and the x-grid
+int MapView::get_live_height() const
+{
+  return MAX_SIZE + 3;
+}
+
+// print the display parameters; the map starts empty
+const string& MapView::draw_header_init(ostream& os, bool& plot)
+{
+  os << "Display size: " << get_x_bound() << ", scale: " << get_grid_scale()
+    << ", origin: " << get_grid_origin() << endl;
+  has_outranger = false;
+  return EMPTY;
+}
+
+// list the objects outside the map, in alphabetical order
+void MapView::draw_outside(ostream& os, const string& name)
+{
+  if (has_outranger) {
+    os << ", ";
+  }
+  os << name;
+  has_outranger = true;
+}
+
+// end the list of objects outside the map
+void MapView::draw_header_end(ostream& os)
+{
+  if (has_outranger) os << " outside the map" << endl;
+}
+
+// label every GRID_STEP'th row counting down from the top multiple of GRID_STEP
+void MapView::draw_y_grid(ostream& os, int y)
+{
+  draw_y_label(os, y, get_grid_scale(), get_grid_origin().y);
+}
+
+// output the x-grid
+void MapView::draw_x_grid(ostream& os)
+{
+  draw_x_labels(os, get_x_bound(), get_grid_scale(), get_grid_origin().x);
 }
 
 const int SailingDataView::WIDTH = 10;
 
+// the notifications this view consumes
+unsigned SailingDataView::get_interests() const
+{
+  return SPEED | COURSE | FUEL | REMOVE;
+}
+
 // update ship's speed 
 void SailingDataView::update_ship_speed(const std::string& name, double value)
 {
@@ -230,21 +259,16 @@ const Point BridgeView::PLOT_ORIGIN = Point(-90, 0);
 const std::string BridgeView::MULTIPLE = "**"; // for drawing
 const std::string BridgeView::EMPTY = ". "; //for drawing
 const std::string BridgeView::WATER = "w-"; //for drawing
+const std::string BridgeView::NO_GRID = "     "; //for drawing
 
 BridgeView::BridgeView(std::string ownship_)
-  :ownship(ownship_)
+  :GridView<BridgeView>(X_SIZE, Y_SIZE, DEFAULT_SCALE, PLOT_ORIGIN), ownship(ownship_)
 {}
 
-// Save the supplied name and location for future use in a draw() call
-// If the name is already present,the new location replaces the previous one.
-void BridgeView::update_location(const std::string& name, Point location)
+// the notifications this view consumes
+unsigned BridgeView::get_interests() const
 {
-  auto pair = objects.find(name);
-  if (pair == objects.end()) {
-    objects.insert(std::pair<string, Point>(name, location));
-  } else {
-    pair->second = location;
-  }
+  return LOCATION | COURSE | REMOVE;
 }
 
 void BridgeView::update_ship_course(const std::string& name, double value)
@@ -257,90 +281,453 @@ void BridgeView::update_ship_course(const std::string& name, double value)
 void BridgeView::update_remove(const std::string& name)
 {
   if (name == ownship) {
-    ownship_sunk_point = objects.find(ownship)->second;
+    ownship_sunk_point = get_objects().find(ownship)->second;
   }
-  objects.erase(name);
+  GridView<BridgeView>::update_remove(name);
 }
 
-void BridgeView::draw()
+// header, the view rows, and the x-grid
+int BridgeView::get_live_height() const
 {
-  vector<vector<string>> arr;
-  auto ship = objects.find(ownship);
-  if (ship == objects.end()) {
-    cout << "Bridge view from " << ownship << " sunk at " << ownship_sunk_point << endl;
-    arr = vector<vector<string>>(X_SIZE, vector<string>(Y_SIZE, WATER));
-  } else {
-    arr = vector<vector<string>>(X_SIZE, vector<string>(Y_SIZE, EMPTY));
-    Point ownship_point = ship->second;
-    cout << "Bridge view from " << ownship << " position " << ownship_point << " heading " << ownship_course << endl;
-    for (auto it : objects) {
-      if (it.first == ownship) continue;
-      Compass_position cp(ownship_point, it.second);
-      // only ships in [0.005, 20] range are shown
-      if (cp.range >= 0.005 && cp.range <= 20) {
-        int AoB = cp.bearing - ownship_course;
-        if (AoB + HALF_ANGLE < 0) {
-          AoB += FULL_ANGLE;
-        } else if (AoB - HALF_ANGLE > 0) {
-          AoB -= FULL_ANGLE;
-        }
-        
-        int x, y;
-        if (get_subscripts(x, y, Point(AoB, 0))){
-          if (arr[x][y] != EMPTY) {
-              arr[x][y] = MULTIPLE;
-          } else {
-            arr[x][y] = it.first.substr(0,2);
-          }
-        }
-      }
+  return Y_SIZE + 2;
+}
+
+// print where ownship is; the view is water if ownship is sunk
+const string& BridgeView::draw_header_init(ostream& os, bool& plot)
+{
+  auto ship = get_objects().find(ownship);
+  if (ship == get_objects().end()) {
+    os << "Bridge view from " << ownship << " sunk at " << ownship_sunk_point << endl;
+    plot = false;
+    return WATER;
+  }
+  ownship_point = ship->second;
+  os << "Bridge view from " << ownship << " position " << ownship_point << " heading " << ownship_course << endl;
+  return EMPTY;
+}
+
+// plot other objects in [0.005, 20] range at their angle on the bow
+bool BridgeView::get_draw_location(Point& out, const string& name, Point in)
+{
+  if (name == ownship) return false;
+  Compass_position cp(ownship_point, in);
+  // only ships in [0.005, 20] range are shown
+  if (cp.range < 0.005 || cp.range > 20) return false;
+  int AoB = cp.bearing - ownship_course;
+  if (AoB + HALF_ANGLE < 0) {
+    AoB += FULL_ANGLE;
+  } else if (AoB - HALF_ANGLE > 0) {
+    AoB -= FULL_ANGLE;
+  }
+  out = Point(AoB, 0);
+  return true;
+}
+
+// the rows are not labeled
+void BridgeView::draw_y_grid(ostream& os, int y)
+{
+  os << NO_GRID;
+}
+
+// output the x-grid
+void BridgeView::draw_x_grid(ostream& os)
+{
+  for (int x_grid=-90; x_grid <= 90; x_grid += 30) {
+    os << setw(6) << x_grid;
+  }
+  os << endl;
+}
+
+const double DensityView::BASE_CELL = 0.125;
+const int DensityView::DEFAULT_SIZE = 25;
+const double DensityView::DEFAULT_SCALE = 2.0;
+const Point DensityView::DEFAULT_ORIGIN = Point(-10, -10);
+const string DensityView::RAMP = ":-=+*#%@";
+
+// the index of level 0 cell c at level l, rounding down for negative cells
+static long long cell_at_level(long long c, int l)
+{
+  return c >= 0 ? c >> l : -((-c - 1) >> l) - 1;
+}
+
+// a hash key for a cell
+static long long cell_key(long long cx, long long cy)
+{
+  return (long long)(((unsigned long long)cx << 32) ^ ((unsigned long long)cy & 0xffffffffULL));
+}
+
+// default constructor sets the default size, scale, and origin
+DensityView::DensityView()
+  :pyramid(LEVELS), ramp(false), filter("all")
+{
+  std::fill(type_totals, type_totals + MAX_TYPES, 0);
+  set_defaults();
+}
+
+// the notifications this view consumes
+unsigned DensityView::get_interests() const
+{
+  return TYPE | LOCATION | REMOVE;
+}
+
+// remember a ship's type, so that its location is counted
+void DensityView::update_ship_type(const std::string& name, const std::string& type_name)
+{
+  if (objects.count(name)) return;
+  auto type_it = std::find(type_names.begin(), type_names.end(), type_name);
+  int type = int(type_it - type_names.begin());
+  if (type_it == type_names.end()) type_names.push_back(type_name);
+  Entry entry = {std::min(type, MAX_TYPES - 1), false, 0, 0};
+  objects.insert(std::make_pair(name, entry));
+}
+
+// move the ship's count to the cells containing the new location; only the
+// levels at which the ship changed cells are touched. An object whose type
+// was not sent first is not a ship, and is not counted.
+void DensityView::update_location(const std::string& name, Point location)
+{
+  long long cx = (long long)floor(location.x / BASE_CELL);
+  long long cy = (long long)floor(location.y / BASE_CELL);
+  auto it = objects.find(name);
+  if (it == objects.end()) {
+    Entry entry = {-1, true, cx, cy};
+    objects.insert(std::make_pair(name, entry));
+    return;
+  }
+  Entry& entry = it->second;
+  if (entry.type < 0) return;
+  if (!entry.placed) {
+    entry.placed = true;
+    entry.cx = cx;
+    entry.cy = cy;
+    add_count(cx, cy, entry.type, 1, LEVELS);
+    ++type_totals[entry.type];
+    return;
+  }
+  int levels = 0;
+  while (levels < LEVELS && (cell_at_level(cx, levels) != cell_at_level(entry.cx, levels)
+      || cell_at_level(cy, levels) != cell_at_level(entry.cy, levels))) {
+    ++levels;
+  }
+  if (levels == 0) return;
+  add_count(entry.cx, entry.cy, entry.type, -1, levels);
+  add_count(cx, cy, entry.type, 1, levels);
+  entry.cx = cx;
+  entry.cy = cy;
+}
+
+// remove a ship's count; no error if the name is not present
+void DensityView::update_remove(const std::string& name)
+{
+  auto it = objects.find(name);
+  if (it == objects.end()) return;
+  if (it->second.type >= 0 && it->second.placed) {
+    add_count(it->second.cx, it->second.cy, it->second.type, -1, LEVELS);
+    --type_totals[it->second.type];
+  }
+  objects.erase(it);
+}
+
+// prints out the counts of the cells of the current level in view
+void DensityView::draw()
+{
+  double cell_size = ldexp(BASE_CELL, level);
+  long long base_x = (long long)floor(origin.x / cell_size);
+  long long base_y = (long long)floor(origin.y / cell_size);
+  cout << "Density size: " << size << ", scale: " << cell_size << ", origin: "
+    << Point(base_x * cell_size, base_y * cell_size) << ", showing: " << filter << endl;
+
+  int type = get_filter_type();
+  vector<int> counts(size * size);
+  int visible = 0, highest = 0;
+  for (int x = 0; x < size; ++x) {
+    for (int y = 0; y < size; ++y) {
+      int count = get_count(base_x + x, base_y + y, type);
+      counts[x * size + y] = count;
+      visible += count;
+      highest = std::max(highest, count);
     }
   }
-  // output map
+  int total = 0;
+  if (type == ALL_TYPES)
+    total = std::accumulate(type_totals, type_totals + MAX_TYPES, 0);
+  else if (type != NO_TYPE)
+    total = type_totals[type];
+  if (total > visible) cout << total - visible << " ships outside the map" << endl;
+
   int precision = cout.precision();
   cout.precision(0);
-  string space = "     ";
-  for (int i = Y_SIZE-1; i >= 0; --i) {
-    cout << space;
-    for (int j = 0; j < X_SIZE; ++j) {
-      cout << arr[j][i];
+  for (int y = size-1; y >= 0; --y) {
+    MapView::draw_y_label(cout, y, cell_size, base_y * cell_size);
+    for (int x = 0; x < size; ++x) {
+      int count = counts[x * size + y];
+      if (count == 0) {
+        cout << ". ";
+      } else if (ramp) {
+        int shade = int(ceil(double(count) * RAMP.size() / highest)) - 1;
+        cout << RAMP[shade] << ' ';
+      } else if (count < 10) {
+        cout << count << ' ';
+      } else if (count < 100) {
+        cout << count;
+      } else {
+        cout << "++";
+      }
     }
     cout << endl;
   }
-  // output the x-grid
-  for (int x_grid=-90; x_grid <= 90; x_grid += 30) {
-    cout << setw(6) << x_grid;
-  }
-  cout << endl;
-  //restore
+  MapView::draw_x_labels(cout, size, cell_size, base_x * cell_size);
   cout.precision(precision);
 }
 
 // Discard the saved information
-void BridgeView::clear()
+void DensityView::clear()
 {
+  for (auto& cells : pyramid) {
+    cells.clear();
+  }
   objects.clear();
+  std::fill(type_totals, type_totals + MAX_TYPES, 0);
 }
 
-// Calculate the cell subscripts corresponding to the supplied location parameter, 
-// using the default size, scale, and origin of the display. 
-// This function assumes that origin is a  member variable of type Point, 
-// scale is a double value, and size is an integer for the number of rows/columns 
-// currently being used for the grid.
-// Return true if the location is within the grid, false if not
-bool BridgeView::get_subscripts(int &ix, int &iy, Point location)
-{
-  // adjust with origin and scale
-  Cartesian_vector subscripts = (location - PLOT_ORIGIN) / DEFAULT_SCALE;
-  // truncate coordinates to integer after taking the floor
-  // floor function will produce integer smaller than even for negative values, 
-  // so - 0.05 => -1., which will be outside the array.
-  ix = int(floor(subscripts.delta_x));
-  iy = int(floor(subscripts.delta_y));
-  // if out of range, return false
-  if ((ix < 0) || (ix >= X_SIZE) || (iy < 0) || (iy >= Y_SIZE)) {
-    return false;
-    }
+// modify the display parameters
+void DensityView::set_size(int size_)
+{
+  if (size_ > MapView::MAX_SIZE)
+    throw Error("New map size is too big!");
+  if (size_ <= 6)
+    throw Error("New map size is too small!");
+  size = size_;
+}
+
+// the scale is rounded to the nearest level of the pyramid
+void DensityView::set_scale(double scale_)
+{
+  if (scale_ <= 0.0)
+    throw Error("New map scale must be positive!");
+  int new_level = int(floor(log2(scale_ / BASE_CELL) + 0.5));
+  level = std::max(0, std::min(new_level, LEVELS - 1));
+}
+
+// any values are legal for the origin
+void DensityView::set_origin(Point origin_)
+{
+  origin = origin_;
+}
+
+// set display parameters to the defaults
+void DensityView::set_defaults()
+{
+  size = DEFAULT_SIZE;
+  set_scale(DEFAULT_SCALE);
+  origin = DEFAULT_ORIGIN;
+}
+
+// "counts" prints the number of ships, "ramp" a density character
+void DensityView::set_style(const std::string& style_)
+{
+  if (style_ == "counts")
+    ramp = false;
+  else if (style_ == "ramp")
+    ramp = true;
   else
-    return true;
+    throw Error("Unrecognized density style!");
+}
+
+// "all" counts every ship type, otherwise only ships of the named type
+void DensityView::set_filter(const std::string& filter_)
+{
+  filter = filter_;
+}
+
+// add delta to the counts of the cells holding level 0 cell (cx, cy)
+// at the lowest levels levels of the pyramid
+void DensityView::add_count(long long cx, long long cy, int type, int delta, int levels)
+{
+  for (int l = 0; l < levels; ++l) {
+    long long key = cell_key(cell_at_level(cx, l), cell_at_level(cy, l));
+    Cell& cell = pyramid[l][key]; // a new cell starts zeroed
+    cell.total += delta;
+    cell.counts[type] += delta;
+    if (cell.total == 0)
+      pyramid[l].erase(key);
+  }
+}
+
+// the count index of the filtered type, ALL_TYPES, or NO_TYPE if never seen
+int DensityView::get_filter_type() const
+{
+  if (filter == "all") return ALL_TYPES;
+  auto type_it = std::find(type_names.begin(), type_names.end(), filter);
+  if (type_it == type_names.end()) return NO_TYPE;
+  return std::min(int(type_it - type_names.begin()), MAX_TYPES - 1);
+}
+
+// the number of ships of the type counted in the cell (cx, cy) at the current level
+int DensityView::get_count(long long cx, long long cy, int type) const
+{
+  if (type == NO_TYPE) return 0;
+  auto it = pyramid[level].find(cell_key(cx, cy));
+  if (it == pyramid[level].end()) return 0;
+  return type == ALL_TYPES ? it->second.total : it->second.counts[type];
+}
+
+// open the file and write the format header
+TelemetryView::TelemetryView(const std::string& filename_, Format format_)
+  :filename(filename_), format(format_), writer(new Buffered_writer(filename_)),
+  rows_written(0), last_id(0)
+{
+  if (format == Format::CSV) {
+    writer->append("tick,name,x,y,course,speed,fuel\n");
+    return;
+  }
+  const char* names[] = {"tick", "name", "x", "y", "course", "speed", "fuel"};
+  const char types[] = {'i', 'u', 'd', 'd', 'd', 'd', 'd'};
+  uint32_t count = sizeof(types);
+  writer->append("P5TELEM1", 8);
+  writer->append(reinterpret_cast<const char*>(&count), sizeof(count));
+  for (uint32_t i = 0; i < count; ++i) {
+    char length = char(strlen(names[i]));
+    writer->append(&types[i], 1);
+    writer->append(&length, 1);
+    writer->append(names[i], length);
+  }
+}
+
+// the writer flushes and closes the file when destroyed
+TelemetryView::~TelemetryView()
+{
+  writer->close();
+  report_losses();
+}
+
+// the notifications this view consumes
+unsigned TelemetryView::get_interests() const
+{
+  return ALL_INTERESTS;
+}
+
+void TelemetryView::update_location(const std::string& name, Point location)
+{
+  get_record(name).location = location;
+}
+
+void TelemetryView::update_ship_speed(const std::string& name, double value)
+{
+  Ship_record& record = get_record(name);
+  record.speed = value;
+  record.is_ship = true;
+}
+
+void TelemetryView::update_ship_course(const std::string& name, double value)
+{
+  Ship_record& record = get_record(name);
+  record.course = value;
+  record.is_ship = true;
+}
+
+void TelemetryView::update_ship_fuel(const std::string& name, double value)
+{
+  Ship_record& record = get_record(name);
+  record.fuel = value;
+  record.is_ship = true;
+}
+
+void TelemetryView::update_remove(const std::string& name)
+{
+  objects.erase(name);
+}
+
+// write a row for every ship
+void TelemetryView::update_tick(int time)
+{
+  if (format == Format::CSV)
+    write_csv_rows(time);
+  else
+    write_binary_block(time);
+}
+
+// prints out where the telemetry is going and how much was written
+void TelemetryView::draw()
+{
+  cout << "Telemetry to " << filename << ": " << rows_written << " rows" << endl;
+  report_losses();
+}
+
+// print what the writer lost, if anything
+void TelemetryView::report_losses() const
+{
+  if (writer->get_dropped_buffers())
+    cout << "Telemetry dropped " << writer->get_dropped_buffers() << " buffers of rows!" << endl;
+  if (writer->has_failed())
+    cout << "Cannot write telemetry file!" << endl;
+}
+
+void TelemetryView::clear()
+{
+  objects.clear();
+}
+
+// the record for name, added if not yet present
+TelemetryView::Ship_record& TelemetryView::get_record(const std::string& name)
+{
+  auto it = objects.find(name);
+  if (it == objects.end()) {
+    Ship_record record = {Point(), 0., 0., 0., false, 0};
+    it = objects.insert(std::make_pair(name, record)).first;
+  }
+  return it->second;
+}
+
+void TelemetryView::write_csv_rows(int time)
+{
+  char line[256];
+  for (auto& obj : objects) {
+    const Ship_record& record = obj.second;
+    if (!record.is_ship) continue;
+    int n = snprintf(line, sizeof(line), "%d,", time);
+    writer->append(line, n);
+    writer->append(obj.first);
+    n = snprintf(line, sizeof(line), ",%.17g,%.17g,%.17g,%.17g,%.17g\n", record.location.x,
+      record.location.y, record.course, record.speed, record.fuel);
+    writer->append(line, n);
+    ++rows_written;
+  }
+}
+
+void TelemetryView::write_binary_block(int time)
+{
+  vector<uint32_t> ids;
+  vector<const Ship_record*> records;
+  for (auto& obj : objects) {
+    Ship_record& record = obj.second;
+    if (!record.is_ship) continue;
+    if (record.id == 0) {
+      record.id = ++last_id;
+      uint16_t length = uint16_t(obj.first.size());
+      writer->append("N", 1);
+      writer->append(reinterpret_cast<const char*>(&record.id), sizeof(record.id));
+      writer->append(reinterpret_cast<const char*>(&length), sizeof(length));
+      writer->append(obj.first.data(), length);
+    }
+    ids.push_back(record.id);
+    records.push_back(&record);
+  }
+  uint32_t rows = uint32_t(records.size());
+  // transpose the rows into one array per column
+  columns.resize(5 * rows);
+  for (uint32_t row = 0; row < rows; ++row) {
+    columns[row] = records[row]->location.x;
+    columns[rows + row] = records[row]->location.y;
+    columns[2 * rows + row] = records[row]->course;
+    columns[3 * rows + row] = records[row]->speed;
+    columns[4 * rows + row] = records[row]->fuel;
+  }
+  int32_t tick = time;
+  writer->append("T", 1);
+  writer->append(reinterpret_cast<const char*>(&tick), sizeof(tick));
+  writer->append(reinterpret_cast<const char*>(&rows), sizeof(rows));
+  writer->append(reinterpret_cast<const char*>(ids.data()), rows * sizeof(uint32_t));
+  writer->append(reinterpret_cast<const char*>(columns.data()), columns.size() * sizeof(double));
+  rows_written += rows;
 }
@@ -2,16 +2,124 @@
 #define VIEWS_H
 #include "View.h"
 #include <map>
+#include <unordered_map>
+#include <vector>
+#include <string>
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <cmath>
+#include <memory>
 
-class MapView : public View {
+class Buffered_writer;
+
+/* Live_frame remembers the last frame a view emitted in live display mode.
+A frame occupies a fixed block of terminal rows; after the first full write, emit()
+only writes the cells that changed since the previous frame, each run positioned
+with an ANSI cursor sequence, so a mostly static picture costs a few bytes per frame.
+*/
+class Live_frame {
 public:
-  MapView();
-  // get all objects' location
+  Live_frame();
+  // occupy height rows starting at the 1-based terminal row top_row_;
+  // forget the previous frame so the next emit writes the whole block
+  void place(int top_row_, int height_);
+  // write text (lines separated by '\n') to cout as a delta against the last frame
+  void emit(const std::string& text);
+
+private:
+  int top_row;
+  int height;
+  bool has_frame; // false until the first full write after place()
+  std::vector<std::string> lines; // the last emitted frame, one entry per row
+};
+
+/* GridView is the base of the views that plot objects by name on a grid of cells.
+It remembers the objects' locations, rasterizes them into a flat buffer of
+two-character cells, and prints the buffer a row at a time between the grid labels.
+It is a CRTP template: the Derived view supplies the hooks below, which draw() calls
+directly, so the loops over objects and rows carry no virtual calls.
+
+Hooks Derived provides (privately, befriending GridView<Derived>):
+  // print the header; return the cell filling the empty grid, and set plot
+  // to false if no objects are to be plotted
+  const std::string& draw_header_init(std::ostream& os, bool& plot);
+  // calculate the point to plot for an object; return false to skip it
+  bool get_draw_location(Point& out, const std::string& name, Point in);
+  // an object's point fell outside the grid
+  void draw_outside(std::ostream& os, const std::string& name);
+  // all objects are plotted; finish the header
+  void draw_header_end(std::ostream& os);
+  // the cell marking more than one object
+  const std::string& get_multiple_str() const;
+  // print the label starting row y, and the x-grid below the last row
+  void draw_y_grid(std::ostream& os, int y);
+  void draw_x_grid(std::ostream& os);
+  // number of terminal rows reserved for the view in live display
+  int get_live_height() const;
+*/
+template<typename Derived>
+class GridView : public View {
+public:
+  // Save the supplied name and location for future use in a draw() call
+  // If the name is already present,the new location replaces the previous one.
   void update_location(const std::string& name, Point location) override;
-  // remove an object
+  // Remove the name and its location; no error if the name is not present.
   void update_remove(const std::string& name) override;
+  // prints out the current grid, or only its changes in live display
   void draw() override;
+  // Discard the saved information
   void clear() override;
+
+  // live display: draw() writes only the changed cells of a frame fixed at top_row
+  void set_live(int top_row);
+  // go back to printing the whole grid on every draw()
+  void set_normal();
+
+  // print the label of row y of a grid with the given scale and origin, every
+  // GRID_STEP'th row, and the labels of the columns below the last row
+  static void draw_y_label(std::ostream& os, int y, double scale_, double origin_y);
+  static void draw_x_labels(std::ostream& os, int x_bound_, double scale_, double origin_x);
+
+protected:
+  static const int GRID_STEP = 3; // step for printing a grid number
+
+  GridView(int x_bound_, int y_bound_, double scale_, Point origin_);
+
+  // interface for derived views to set and read the grid parameters
+  void set_grid_size(int x_bound_, int y_bound_);
+  void set_grid_scale(double scale_);
+  void set_grid_origin(Point origin_);
+  int get_x_bound() const {return x_bound;}
+  int get_y_bound() const {return y_bound;}
+  double get_grid_scale() const {return scale;}
+  Point get_grid_origin() const {return origin;}
+  const std::map<std::string, Point>& get_objects() const {return objects;}
+
+private:
+  std::map<std::string, Point> objects; //ordered list of objects remembered
+  int x_bound, y_bound; // number of cells in the x and y directions
+  double scale;    // distance per cell
+  Point origin;    // coordinates of the lower-left-hand corner
+  bool live;       // true if drawing in live display mode
+  Live_frame frame; // last frame written in live display mode
+  std::string cells; // row-major two-character cells, reused between draws
+
+  // print the header and the grid to os
+  void render(std::ostream& os);
+  // Calculate the cell subscripts corresponding to the location parameter, using the 
+  // current size, scale, and origin of the grid. 
+  // Return true if the location is within the grid, false if not
+  bool get_subscripts(int &ix, int &iy, Point location) const;
+};
+
+class MapView : public GridView<MapView> {
+public:
+  static const int MAX_SIZE; // the largest size a map may be set to
+
+  MapView();
+  // locations and removals only
+  unsigned get_interests() const override;
   
   // modify the display parameters
   // if the size is out of bounds will throw Error("New map size is too big!")
@@ -24,11 +132,21 @@ public:
   // set the parameters to the default values
   void set_defaults();
 
+  // number of terminal rows reserved for the map in live display
+  int get_live_height() const;
+
 private:
-  // Calculate the cell subscripts corresponding to the location parameter, using the 
-  // current size, scale, and origin of the display. 
-  // Return true if the location is within the map, false if not
-  bool get_subscripts(int &ix, int &iy, Point location);
+  friend class GridView<MapView>;
+  // GridView hooks
+  const std::string& draw_header_init(std::ostream& os, bool& plot);
+  bool get_draw_location(Point& out, const std::string& name, Point in)
+    {out = in; return true;}
+  void draw_outside(std::ostream& os, const std::string& name);
+  void draw_header_end(std::ostream& os);
+  const std::string& get_multiple_str() const
+    {return MULTIPLE;}
+  void draw_y_grid(std::ostream& os, int y);
+  void draw_x_grid(std::ostream& os);
 
   static const int DEFAULT_SIZE;
   static const double DEFAULT_SCALE;
@@ -36,14 +154,13 @@ private:
   static const std::string MULTIPLE; // for drawing
   static const std::string EMPTY; //for drawing
 
-  std::map<std::string, Point> objects; //ordered list of objects remembered
-  int size;      // current size of the display
-  double scale;    // distance per cell of the display
-  Point origin;    // coordinates of the lower-left-hand corner
+  bool has_outranger; // true once an object outside the map is listed
 };
 
 class SailingDataView : public View {
 public:
+  // fuel, course, speed and removals only
+  unsigned get_interests() const override;
   // update ship's speed 
   void update_ship_speed(const std::string& name, double value);
   // update ship's course 
@@ -63,24 +180,31 @@ private:
   std::map<std::string, ShipInfo> objects; //ordered list of ship objects remembered
 };
 
-class BridgeView : public View {
+class BridgeView : public GridView<BridgeView> {
 public:
   // initialize with ownship's name
   BridgeView(std::string ownship_);
-  // get all objects' location
-  void update_location(const std::string& name, Point location) override;
+  // locations, course and removals only
+  unsigned get_interests() const override;
   // get the course of ownship 
   void update_ship_course(const std::string& name, double value) override;
   // if the removed ship is ownship, memorize the sunk_point before removing it
   void update_remove(const std::string& name) override;
-  void draw() override;
-  void clear() override;
+
+  // number of terminal rows reserved for the view in live display
+  int get_live_height() const;
 
 private:
-  // Calculate the cell subscripts corresponding to the location parameter, using the 
-  // default size, scale, and origin of the display. 
-  // Return true if the location is within the map, false if not
-  bool get_subscripts(int &ix, int &iy, Point location);
+  friend class GridView<BridgeView>;
+  // GridView hooks
+  const std::string& draw_header_init(std::ostream& os, bool& plot);
+  bool get_draw_location(Point& out, const std::string& name, Point in);
+  void draw_outside(std::ostream& os, const std::string& name) {}
+  void draw_header_end(std::ostream& os) {}
+  const std::string& get_multiple_str() const
+    {return MULTIPLE;}
+  void draw_y_grid(std::ostream& os, int y);
+  void draw_x_grid(std::ostream& os);
 
   static const double FULL_ANGLE, HALF_ANGLE;
   static const int X_SIZE;
@@ -90,11 +214,301 @@ private:
   static const std::string MULTIPLE; // for drawing
   static const std::string EMPTY; //for drawing
   static const std::string WATER; //for drawing
+  static const std::string NO_GRID; //for drawing
 
-  std::map<std::string, Point> objects; //ordered list of objects remembered
   std::string ownship;
   double ownship_course;
   Point ownship_sunk_point;
+  Point ownship_point; // ownship's position while drawing
+};
+
+// GridView member templates
+
+template<typename Derived>
+GridView<Derived>::GridView(int x_bound_, int y_bound_, double scale_, Point origin_)
+  :x_bound(x_bound_), y_bound(y_bound_), scale(scale_), origin(origin_), live(false)
+{}
+
+template<typename Derived>
+void GridView<Derived>::update_location(const std::string& name, Point location)
+{
+  auto pair = objects.find(name);
+  if (pair == objects.end()) {
+    objects.insert(std::pair<std::string, Point>(name, location));
+  } else {
+    pair->second = location;
+  }
+}
+
+template<typename Derived>
+void GridView<Derived>::update_remove(const std::string& name)
+{
+  objects.erase(name);
+}
+
+template<typename Derived>
+void GridView<Derived>::draw()
+{
+  if (!live) {
+    render(std::cout);
+    return;
+  }
+  std::ostringstream os;
+  os.copyfmt(std::cout);
+  render(os);
+  frame.emit(os.str());
+}
+
+template<typename Derived>
+void GridView<Derived>::clear()
+{
+  objects.clear();
+}
+
+template<typename Derived>
+void GridView<Derived>::set_live(int top_row)
+{
+  live = true;
+  frame.place(top_row, static_cast<const Derived*>(this)->get_live_height());
+}
+
+template<typename Derived>
+void GridView<Derived>::set_normal()
+{
+  live = false;
+}
+
+// label every GRID_STEP'th row counting down from the top multiple of GRID_STEP
+template<typename Derived>
+void GridView<Derived>::draw_y_label(std::ostream& os, int y, double scale_, double origin_y)
+{
+  if (y % GRID_STEP == 0) {
+    os << std::setw(4) << (y * scale_ + origin_y) << " ";
+  } else {
+    os << "     ";
+  }
+}
+
+// output the x-grid
+template<typename Derived>
+void GridView<Derived>::draw_x_labels(std::ostream& os, int x_bound_, double scale_, double origin_x)
+{
+  for (int x_grid=0; x_grid < x_bound_; x_grid += GRID_STEP) {
+    os << std::setw(6) << (x_grid * scale_ + origin_x);
+  }
+  os << std::endl;
+}
+
+template<typename Derived>
+void GridView<Derived>::set_grid_size(int x_bound_, int y_bound_)
+{
+  x_bound = x_bound_;
+  y_bound = y_bound_;
+}
+
+template<typename Derived>
+void GridView<Derived>::set_grid_scale(double scale_)
+{
+  scale = scale_;
+}
+
+template<typename Derived>
+void GridView<Derived>::set_grid_origin(Point origin_)
+{
+  origin = origin_;
+}
+
+// plot the objects in alphabetical order, then print the grid top row first
+template<typename Derived>
+void GridView<Derived>::render(std::ostream& os)
+{
+  Derived& self = static_cast<Derived&>(*this);
+  bool plot = true;
+  const std::string& fill = self.draw_header_init(os, plot);
+  const std::string& multiple = self.get_multiple_str();
+  cells.resize(2 * x_bound * y_bound);
+  for (std::string::size_type i = 0; i < cells.size(); i += 2) {
+    cells[i] = fill[0];
+    cells[i + 1] = fill[1];
+  }
+  if (plot) {
+    for (auto& obj : objects) {
+      Point location;
+      if (!self.get_draw_location(location, obj.first, obj.second)) continue;
+      int ix, iy;
+      if (get_subscripts(ix, iy, location)) {
+        char* cell = &cells[2 * (iy * x_bound + ix)];
+        if (cell[0] != fill[0] || cell[1] != fill[1]) {
+          cell[0] = multiple[0];
+          cell[1] = multiple[1];
+        } else {
+          cell[0] = obj.first[0];
+          cell[1] = obj.first.size() > 1 ? obj.first[1] : ' ';
+        }
+      } else {
+        self.draw_outside(os, obj.first);
+      }
+    }
+    self.draw_header_end(os);
+  }
+  int precision = os.precision();
+  os.precision(0);
+  for (int y = y_bound - 1; y >= 0; --y) {
+    self.draw_y_grid(os, y);
+    os.write(&cells[2 * y * x_bound], 2 * x_bound);
+    os << std::endl;
+  }
+  self.draw_x_grid(os);
+  //restore
+  os.precision(precision);
+}
+
+// Calculate the cell subscripts corresponding to the supplied location parameter, 
+// using the current size, scale, and origin of the grid. 
+// Return true if the location is within the grid, false if not
+template<typename Derived>
+bool GridView<Derived>::get_subscripts(int &ix, int &iy, Point location) const
+{
+  // adjust with origin and scale
+  Cartesian_vector subscripts = (location - origin) / scale;
+  // truncate coordinates to integer after taking the floor
+  // floor function will produce integer smaller than even for negative values, 
+  // so - 0.05 => -1., which will be outside the array.
+  ix = int(floor(subscripts.delta_x));
+  iy = int(floor(subscripts.delta_y));
+  return !((ix < 0) || (ix >= x_bound) || (iy < 0) || (iy >= y_bound));
+}
+
+/* DensityView shows how many ships are in each cell of the map, by ship type.
+Counts are kept in a pyramid of grids: level 0 has cells of BASE_CELL nm, and every
+level above doubles the cell size, so a location update moves a ship's count in at
+most one cell per level, and a draw at any zoom reads the cells of one level only.
+Zoom is therefore restricted to the pyramid's power-of-two scales, and the origin
+is rounded down to a cell corner of the current level.
+*/
+class DensityView : public View {
+public:
+  DensityView();
+  // types, locations and removals only
+  unsigned get_interests() const override;
+  // remember a ship's type, so that its location is counted
+  void update_ship_type(const std::string& name, const std::string& type_name) override;
+  // move the ship's count to the cells containing the new location
+  void update_location(const std::string& name, Point location) override;
+  // remove a ship's count
+  void update_remove(const std::string& name) override;
+  void draw() override;
+  void clear() override;
+
+  // modify the display parameters, with the same limits and errors as the MapView
+  void set_size(int size_);
+  // the scale is rounded to the nearest level of the pyramid
+  void set_scale(double scale_);
+  void set_origin(Point origin_);
+  void set_defaults();
+  // "counts" prints the number of ships, "ramp" a density character
+  // will throw Error("Unrecognized density style!")
+  void set_style(const std::string& style_);
+  // "all" counts every ship type, otherwise only ships of the named type
+  void set_filter(const std::string& filter_);
+
+private:
+  static const int MAX_TYPES = 16; // later types share the last count
+  static const int LEVELS = 14;
+  static const int ALL_TYPES = -1;
+  static const int NO_TYPE = -2;
+  static const double BASE_CELL;
+  static const int DEFAULT_SIZE;
+  static const double DEFAULT_SCALE;
+  static const Point DEFAULT_ORIGIN;
+  static const std::string RAMP;
+
+  struct Cell {
+    int total;
+    int counts[MAX_TYPES];
+  };
+  // a ship's type index, and its cell at level 0 once it has a location,
+  // or type -1 for other objects
+  struct Entry {
+    int type;
+    bool placed;
+    long long cx, cy;
+  };
+
+  std::vector<std::unordered_map<long long, Cell>> pyramid; // cells by level
+  std::unordered_map<std::string, Entry> objects;
+  std::vector<std::string> type_names; // in the order first seen
+  int type_totals[MAX_TYPES]; // number of ships counted of each type
+  int size;      // current size of the display
+  int level;     // pyramid level shown; the scale is BASE_CELL * 2^level
+  Point origin;  // coordinates of the lower-left-hand corner requested
+  bool ramp;     // true to draw density characters instead of counts
+  std::string filter; // the type shown, or "all"
+
+  // add delta to the counts of the cells holding level 0 cell (cx, cy)
+  // at the lowest levels levels of the pyramid
+  void add_count(long long cx, long long cy, int type, int delta, int levels);
+  // the count index of the filtered type, ALL_TYPES, or NO_TYPE if never seen
+  int get_filter_type() const;
+  // the number of ships of the type counted in the cell (cx, cy) at the current level
+  int get_count(long long cx, long long cy, int type) const;
+};
+
+/* TelemetryView writes the state of every ship at the end of every tick to a file,
+as rows of tick, name, x, y, course, speed and fuel, for offline analysis.
+CSV: a header line, then one line per row.
+Binary (host byte order): the magic "P5TELEM1", a uint32 column count, and for each
+column a type byte ('i' int32, 'u' uint32, 'd' double), a length byte, and its name.
+Then records, each starting with a tag byte:
+  'N' uint32 id, uint16 length, name - names a ship id before its first row
+  'T' int32 tick, uint32 rows, then the columns for those rows one after another:
+      uint32 id[rows], double x[rows], y[rows], course[rows], speed[rows], fuel[rows]
+The file is written through a Buffered_writer, so the disk never holds up an update.
+If the disk falls so far behind that the writer drops rows, or a write fails, draw
+and the destructor report it.
+*/
+class TelemetryView : public View {
+public:
+  enum class Format {CSV, BINARY};
+  // will throw Error("Cannot open output file!")
+  TelemetryView(const std::string& filename_, Format format_);
+  // writes out any rows not yet written, and reports any rows lost
+  ~TelemetryView();
+  // every notification, including the end of each tick
+  unsigned get_interests() const override;
+  void update_location(const std::string& name, Point location) override;
+  void update_ship_speed(const std::string& name, double value) override;
+  void update_ship_course(const std::string& name, double value) override;
+  void update_ship_fuel(const std::string& name, double value) override;
+  void update_remove(const std::string& name) override;
+  // write a row for every ship
+  void update_tick(int time) override;
+  // prints out where the telemetry is going and how much was written
+  void draw() override;
+  void clear() override;
+
+private:
+  struct Ship_record {
+    Point location;
+    double course, speed, fuel;
+    bool is_ship; // islands only report their location
+    unsigned id;  // binary name id, 0 until the ship's first row
+  };
+  std::map<std::string, Ship_record> objects; //ordered list of objects remembered
+  std::string filename;
+  Format format;
+  std::unique_ptr<Buffered_writer> writer;
+  long rows_written;
+  unsigned last_id;
+  std::vector<double> columns; // scratch for a binary tick block
+
+  // print what the writer lost, if anything
+  void report_losses() const;
+
+  // the record for name, added if not yet present
+  Ship_record& get_record(const std::string& name);
+  void write_csv_rows(int time);
+  void write_binary_block(int time);
 };
 
 #endif
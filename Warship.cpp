@@ -1,4 +1,5 @@
 #include "Warship.h"
+#include "Model.h"
 #include "Utility.h"
 #include <iostream>
 using std::cout;
@@ -6,11 +7,9 @@ using std::endl;
 using std::shared_ptr;
 
 // initialize, then output constructor message
-Warship::Warship(const std::string& name_, Point position_, double fuel_capacity_, 
-    double maximum_speed_, double fuel_consumption_, int resistance_,
-    int firepower_, double maximum_range_)
-  :Ship(name_, position_, fuel_capacity_, maximum_speed_, fuel_consumption_, resistance_),
-  firepower(firepower_), maximum_range(maximum_range_), warship_state(State::NOT_ATTACKING)
+Warship::Warship(const std::string& name_, Point position_, int type_id_)
+  :Ship(name_, position_, type_id_, CAN_ATTACK), warship_state(State::NOT_ATTACKING),
+  patrolling(false), patrol_radius(0.), patrol_speed(0.), patrol_leg(0)
 {}
 
 // perform warship-specific behavior
@@ -18,29 +17,32 @@ void Warship::update()
 {
   Ship::update();
   if (warship_state == State::ATTACKING) { //NOTE: FLAT
-    if (!is_afloat() || target.expired() || !target.lock()->is_afloat()) {
+    Ship* target_ptr = get_target();
+    if (!is_afloat() || !target_ptr || !target_ptr->is_afloat()) {
       stop_attack();
     } else {
       cout << get_name() << " is attacking" << endl;
     }
   }
+  if (patrolling)
+    continue_patrol();
 }
 
 // attack on the ship supplied, throw error if can't attack
 // or made attacking the wrong target
-void Warship::attack(shared_ptr<Ship> target_ptr_)
+void Warship::attack(Ship& target_)
 {
   if (!is_afloat()) //NOTE: FLAT
     throw Error("Cannot attack!");
   else {
-    if (target_ptr_ == shared_from_this()) {
+    if (&target_ == this) {
       throw Error("Warship may not attack itself!");
-    } else if (target_ptr_ == target.lock()){
+    } else if (&target_ == get_target()){
       throw Error ("Already attacking this target!");
     } else {
-      target = target_ptr_;
+      target = target_.get_handle();
       warship_state = State::ATTACKING;
-      cout << get_name() << " will attack " << target.lock()->get_name() << endl;
+      cout << get_name() << " will attack " << target_.get_name() << endl;
     }
   }
 }
@@ -51,21 +53,61 @@ void Warship::stop_attack()
   if (warship_state == State::NOT_ATTACKING) 
     throw Error("Was not attacking!");
   warship_state = State::NOT_ATTACKING;
-  target.reset();
+  target = Ship_handle();
   cout << get_name() << " stopping attack" << endl;
 }
 
+// patrol the area within the radius of the center, at the speed
+void Warship::patrol(Point center, double radius, double speed)
+{
+  Ship::set_destination_position_and_speed(center, speed);
+  patrolling = true;
+  patrol_center = center;
+  patrol_radius = radius;
+  patrol_speed = speed;
+  patrol_leg = 0;
+  cout << get_name() << " will patrol within " << radius << " nm of " << center << endl;
+}
+
+// any movement command ends the patrol, once the ship has accepted it
+void Warship::set_destination_position_and_speed(Point destination_position, double speed)
+{
+  Ship::set_destination_position_and_speed(destination_position, speed);
+  patrolling = false;
+}
+
+void Warship::set_course_and_speed(double course, double speed)
+{
+  Ship::set_course_and_speed(course, speed);
+  patrolling = false;
+}
+
+void Warship::stop()
+{
+  Ship::stop();
+  patrolling = false;
+}
+
+void Warship::dock(const shared_ptr<Island>& island_ptr)
+{
+  Ship::dock(island_ptr);
+  patrolling = false;
+}
+
 // describe a warship's target if attacking
 void Warship::describe() const
 {
   Ship::describe();
   if (warship_state == State::ATTACKING) { // NOTE: NESTED IF
-    if (target.expired() || !target.lock()->is_afloat()) {
+    Ship* target_ptr = get_target();
+    if (!target_ptr || !target_ptr->is_afloat()) {
       cout << "Attacking absent ship" << endl;
     } else {
-      cout << "Attacking " << target.lock()->get_name() << endl;
+      cout << "Attacking " << target_ptr->get_name() << endl;
     }
   }
+  if (patrolling && is_afloat())
+    cout << "Patrolling within " << patrol_radius << " nm of " << patrol_center << endl;
 }
 
 // protected member functions
@@ -80,17 +122,37 @@ bool Warship::is_attacking() const
 void Warship::fire_at_target()
 {
   cout << get_name() << " fires" << endl;
-  target.lock()->receive_hit(firepower, shared_from_this());
+  get_target()->receive_hit(get_type().firepower, *this);
 }
 
 // is the current target in range?
 bool Warship::target_in_range() const
 {
-  return (cartesian_distance(get_location(), target.lock()->get_location()) <= maximum_range);
+  return (cartesian_distance(get_location(), get_target()->get_location()) <= get_type().maximum_range);
 }
 
 // get the target
-shared_ptr<Ship> Warship::get_target() const
+Ship* Warship::get_target() const
 {
-  return target.lock();
+  return Model::get_Instance().get_ship(target);
+}
+
+// private member functions
+
+// sail the next leg once the last is done, and attack the nearest ship in range if not attacking
+void Warship::continue_patrol()
+{
+  if (!is_afloat())
+    return;
+  if (can_move() && !is_moving()) {
+    static const Cartesian_vector legs[] = {{0., 1.}, {1., 0.}, {0., -1.}, {-1., 0.}};
+    Ship::set_destination_position_and_speed(patrol_center + legs[patrol_leg] * patrol_radius, patrol_speed);
+    patrol_leg = (patrol_leg + 1) % 4;
+  }
+  if (warship_state == State::ATTACKING)
+    return;
+  Ship* hostile = Model::get_Instance().find_nearest_ship(get_location(), get_type().maximum_range,
+    [this](const Ship& ship) {return &ship != this && ship.is_afloat() && !ship.is_patrolling();});
+  if (hostile)
+    attack(*hostile);
 }
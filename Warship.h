@@ -1,7 +1,13 @@
 /* Warship class
-A Warship is a ship with firepower and range member variables, and some services for
+A Warship is a ship with firepower and range, from its type, and some services for
 protected classes to manage many of the details of warship behavior. This is an
 abstract base class, so concrete classes derived from Warship must be declared.
+
+A Warship on patrol sails to the center of its area, then around it through the
+points at the patrol radius to the north, east, south and west. Whenever it is not
+attacking, it attacks the nearest afloat ship within its maximum range that is not
+itself on patrol, found through the Model's spatial index. Any other movement
+command ends the patrol.
 */
 
 #ifndef WARSHIP_H
@@ -18,10 +24,22 @@ public:
   // will  throw Error("Cannot attack!") if not Afloat
   // will throw Error("Warship may not attack itself!")
     // if supplied target is the same as this Warship
-  void attack(std::shared_ptr<Ship> target_ptr_) override;
+  void attack(Ship& target_) override;
 
   // will throw Error("Was not attacking!") if not Attacking
   void stop_attack() override;
+
+  // patrol the area within the radius of the center, at the speed
+  // may throw Error("Ship cannot move!")
+  // may throw Error("Ship cannot go that fast!")
+  void patrol(Point center, double radius, double speed) override;
+  bool is_patrolling() const override {return patrolling;}
+
+  // these end the patrol
+  void set_destination_position_and_speed(Point destination_position, double speed) override;
+  void set_course_and_speed(double course, double speed) override;
+  void stop() override;
+  void dock(const std::shared_ptr<Island>& island_ptr) override;
   
   void describe() const override;
 
@@ -29,9 +47,7 @@ protected:
   // future projects may need additional protected members
 
   // initialize, then output constructor message
-  Warship(const std::string& name_, Point position_, double fuel_capacity_, 
-    double maximum_speed_, double fuel_consumption_, int resistance_,
-    int firepower_, double maximum_range_);
+  Warship(const std::string& name_, Point position_, int type_id_);
 
   // return true if this Warship is in the attacking state
   bool is_attacking() const;
@@ -42,15 +58,21 @@ protected:
   // is the current target in range?
   bool target_in_range() const;
 
-  // get the target
-  std::shared_ptr<Ship> get_target() const;
+  // get the target, nullptr if it is gone
+  Ship* get_target() const;
 
 private:
   enum class State {ATTACKING, NOT_ATTACKING}; //CAN DO WITH A BOOL. DECLARE BETTER IN .CPP FILE
 
-  int firepower; //total firepower
-  double maximum_range; //mamximum attacking range
   State warship_state; //current state
-  std::weak_ptr<Ship> target; //warship's target
+  Ship_handle target; //warship's target
+  bool patrolling;
+  Point patrol_center;
+  double patrol_radius;
+  double patrol_speed;
+  int patrol_leg; // the point at the radius sailed to next, clockwise from north
+
+  // sail the next leg once the last is done, and attack the nearest ship in range if not attacking
+  void continue_patrol();
 };
 #endif
@@ -3,22 +3,74 @@ Main module. Your project must use this file as-is
 */
 
 #include "Controller.h"
+#include "Ship_types.h"
+#include "Utility.h"
 #include <iostream>
+#include <cstring>
+#include <cstdlib>
+#include <climits>
 
 using namespace std;
 
+// read a whole argument as a tick number
+static bool read_tick(const char* text, int& tick)
+{
+	char* end = nullptr;
+	long value = strtol(text, &end, 10);
+	if (!*text || *end || value < INT_MIN || value > INT_MAX)
+		return false;
+	tick = int(value);
+	return true;
+}
+
 // The main function creates the Controller object, then tells it to run.
 
-int main ()
+int main (int argc, char* argv[])
 {		
 	// Set output to show two decimal places
 //	cout << fixed << setprecision(2) << endl;
 	cout.setf(ios::fixed, ios::floatfield);
 	cout.precision(2);
 
+	// an optional table of ship types, loaded before the first ship is created
+	int mode = 1;
+	if (argc >= 3 && strcmp(argv[1], "--ship_types") == 0) {
+		try {
+			Ship_types::load(argv[2]);
+		} catch (Error& e) {
+			cerr << e.what() << endl;
+			return 1;
+		}
+		mode = 3;
+	}
+
 	// create the Controller and go
 	Controller controller;
 
-	controller.run();
+	// an optional journal, then the mode and its arguments
+	if (argc >= mode + 2 && strcmp(argv[mode], "--journal") == 0) {
+		if (!controller.open_journal(argv[mode + 1]))
+			return 1;
+		mode += 2;
+	}
+	int args = argc - mode;
+	int tick = INT_MAX;
+	if (args == 0) {
+		controller.run();
+	} else if (args == 2 && strcmp(argv[mode], "--script") == 0) {
+		controller.run_script(argv[mode + 1]);
+	} else if (args == 2 && strcmp(argv[mode], "--compiled") == 0) {
+		controller.run_compiled(argv[mode + 1]);
+	} else if (args == 2 && strcmp(argv[mode], "--server") == 0) {
+		controller.run_server(argv[mode + 1]);
+	} else if ((args == 2 || (args == 3 && read_tick(argv[mode + 2], tick))) &&
+			strcmp(argv[mode], "--replay") == 0) {
+		// the output is muted until the tick, or until the journal ends
+		controller.run_replay(argv[mode + 1], tick);
+	} else {
+		cerr << "Usage: " << argv[0] << " [--ship_types file] [--journal file] [--script file | --compiled file | "
+			"--server socket | --replay journal [tick]]" << endl;
+		return 1;
+	}
 }
 
@@ -0,0 +1,102 @@
+#!/bin/bash
+# Run the sample transcripts through the program, check that the output is unchanged,
+# and report wall time, instructions and peak RSS for each script.
+#
+# samples/ holds this project's transcripts: a difference there is a failure.
+# samplesP4/ holds the previous project's transcripts, which print constructor and
+# destructor messages this project does not, so they are only timed and a difference
+# is reported as expected.
+#
+# Each script is also run scaled up: repeated SCALES times over, timed only.
+# The first two characters of a name must be unique, so a created ship's name gets
+# a distinguishing two-letter prefix in each copy rather than a suffix.
+#
+# Instructions need perf, and peak RSS needs GNU time at /usr/bin/time; either is
+# reported as n/a when not installed.
+
+PROG=${PROG:-./p5exe}
+SCALES=${SCALES:-"10 100"}
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT
+
+have_perf=false
+command -v perf >/dev/null 2>&1 && perf stat -x, -e instructions true >/dev/null 2>&1 && have_perf=true
+have_time=false
+[ -x /usr/bin/time ] && have_time=true
+
+# run the input through the program into $WORK/out, and set wall, instructions and rss
+measure() {
+	local input=$1
+	local start end
+	instructions=n/a
+	rss=n/a
+	start=$(date +%s.%N)
+	if $have_time; then
+		/usr/bin/time -f %M -o "$WORK/rss" "$PROG" < "$input" > "$WORK/out" 2>/dev/null
+		rss=$(tail -1 "$WORK/rss")
+	else
+		"$PROG" < "$input" > "$WORK/out" 2>/dev/null
+	fi
+	end=$(date +%s.%N)
+	wall=$(echo "$end - $start" | bc -l 2>/dev/null || awk "BEGIN {print $end - $start}")
+	if $have_perf; then
+		perf stat -x, -e instructions -o "$WORK/perf" "$PROG" < "$input" > /dev/null 2>&1
+		instructions=$(grep instructions "$WORK/perf" | cut -d, -f1)
+	fi
+}
+
+# write the script repeated count times to $WORK/scaled, with quit only at the end
+scale() {
+	local input=$1 count=$2
+	awk -v count="$count" '
+		{lines[NR] = $0}
+		$1 == "create" {created[$2] = 1}
+		END {
+			n = 0
+			for (copy = 0; copy < count; ++copy) {
+				# the prefix of each created name in this copy
+				delete prefix
+				if (copy > 0)
+					for (name in created) {
+						prefix[name] = sprintf("%c%c", 97 + int(n / 26) % 26, 97 + n % 26)
+						++n
+					}
+				for (i = 1; i <= NR; ++i) {
+					if (lines[i] == "quit") continue
+					line = lines[i]
+					if (copy > 0) {
+						words = split(line, word, " ")
+						line = ""
+						for (w = 1; w <= words; ++w)
+							line = line (w > 1 ? " " : "") (word[w] in prefix ? prefix[word[w]] word[w] : word[w])
+					}
+					print line
+				}
+			}
+			print "quit"
+		}' "$input" > "$WORK/scaled"
+}
+
+failed=0
+printf "%-28s %-10s %10s %14s %10s\n" script output seconds instructions peak_kB
+for dir in samples samplesP4; do
+	for input in $dir/*_in.txt; do
+		expected=${input%_in.txt}_out.txt
+		measure "$input"
+		if cmp -s "$WORK/out" "$expected"; then
+			result=same
+		elif [ $dir = samples ]; then
+			result=DIFFERS
+			failed=1
+		else
+			result=expected
+		fi
+		printf "%-28s %-10s %10.4f %14s %10s\n" "$input" $result "$wall" "$instructions" "$rss"
+		for count in $SCALES; do
+			scale "$input" $count
+			measure "$WORK/scaled"
+			printf "%-28s %-10s %10.4f %14s %10s\n" "$input x$count" timed "$wall" "$instructions" "$rss"
+		done
+	done
+done
+exit $failed
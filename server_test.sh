@@ -0,0 +1,60 @@
+#!/bin/bash
+# Check that the server applies a client's commands in order at tick boundaries.
+#
+# A client sends go, and then, as a separate write while the tick may still be
+# running, a course change, an unknown command and quit. The course change must not
+# take effect in the go's tick, and the replies must come back in the order the
+# commands were sent: the tick's output first, then the later commands' replies.
+#
+# The client needs python3.
+
+PROG=${PROG:-./p5exe}
+WORK=$(mktemp -d)
+SOCKET=$WORK/p5.sock
+trap 'kill $server 2>/dev/null; rm -rf "$WORK"' EXIT
+
+"$PROG" --server "$SOCKET" > "$WORK/server.out" 2>&1 &
+server=$!
+for i in $(seq 50); do
+	[ -S "$SOCKET" ] && break
+	sleep 0.1
+done
+
+python3 - "$SOCKET" > "$WORK/replies" <<'EOF'
+import socket, sys, time
+client = socket.socket(socket.AF_UNIX)
+client.connect(sys.argv[1])
+# enough ships and output ahead of the go that the later write arrives while they run
+client.sendall(b"".join(b"create_fleet %c%c Cruiser 62 0 0 0.5\n" % (a, a) for a in b"BCDFGH")
+	+ b"status\n" * 100 + b"go\n")
+time.sleep(0.005)
+client.sendall(b"Ajax course 90 10\nbogus_command\nquit\n")
+replies = b""
+while True:
+	data = client.recv(65536)
+	if not data:
+		break
+	replies += data
+sys.stdout.write(replies.decode())
+EOF
+
+failed=false
+# the go's tick must see Ajax still stopped
+if ! grep -q '^Ajax stopped at (15.00, 15.00)$' "$WORK/replies"; then
+	echo "FAIL: Ajax's course changed before the go's tick"
+	failed=true
+fi
+# the replies to the later commands must be the last three lines, in order
+expected='Ajax will sail on course 90.00 deg, speed 10.00 nm/hr
+Unrecognized command!
+Done'
+if [ "$(tail -n 3 "$WORK/replies")" != "$expected" ]; then
+	echo "FAIL: the replies are out of order:"
+	grep -n -e '^Ajax' -e 'Unrecognized' -e '^Done' "$WORK/replies"
+	failed=true
+fi
+
+if $failed; then
+	exit 1
+fi
+echo "server test passed"